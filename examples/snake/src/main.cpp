@@ -14,75 +14,19 @@ int main () {
     pneatm::Population<myInt, myFloat>* pop = SetupPopulation (popSize, logger.get ());
     //pneatm::Population<myInt, myFloat>* pop = LoadPopulation ("snakePneatm_save", logger.get (), "stats_new.csv");
 
-    // init snake
-    Snake snake (8);
-
     // init mutation parameters
     std::function<pneatm::mutationParams_t (double)> paramsMap = SetupMutationParametersMaps ();
 
     unsigned int maxIterationThresh = 500;
     int nbGame = 7;
-    double bestFitness = 0.0;
-    while (bestFitness < 2500.0 && pop->getGeneration () < 300) { // while goal is not reach
-        std::cout << "generation " << pop->getGeneration () << std::endl;
-
-        for (unsigned int genomeId = 0; genomeId < popSize; genomeId ++) {
-
-            float score = 0.0f;
-            for (int g = 0; g < nbGame; g++) {
-                snake.reset ();
-
-                bool isFinished = false;
-                unsigned int iteration = 0;
-                while (iteration < maxIterationThresh && !isFinished) { // while game has not ended
-                    // get inputs from snake's eyes
-                    std::vector<myInt> AI_Inputs = snake.getAIInputs ();
-
-                    // load inputs in the genome's network
-                    for (unsigned int i = 0; i < 14; i++) {
-                        pop->template loadInput<myInt> (AI_Inputs [i], i, genomeId);
-                    }
-                    myFloat score = snake.getScore ();
-                    pop->template loadInput<myFloat> (score, 14, genomeId);
-
-                    // run the network
-                    pop->runNetwork (genomeId);
-
-                    // get output, the movement order to give to the snake
-                    myFloat Snake_Inputs = pop->template getOutput<myFloat> (0, genomeId);
-
-                    // move the snake
-                    isFinished = snake.run (Snake_Inputs);
-
-                    iteration ++;
-                }
-
-                score += snake.getScore ();
-
-                pop->resetMemory (genomeId);
-            }
-
-            // game has ended, we set the score to the genome's fitness
-            pop->setFitness (score / (float) nbGame, genomeId);
-        }
-
-        // speciation step
-        pop->speciate (5, 100, 0.3);
-        bestFitness = pop->getGenome ().getFitness ();
-        const double avgFitness = pop->getAvgFitness ();
-
-        // build the next generation
-        const double crossover_rate = 0.8 - 0.8 / (1.0 + (avgFitness / 350.0) * (avgFitness / 350.0));
-        pop->buildNextGen (paramsMap, true, crossover_rate);
 
-        std::cout << "best fitness: " << bestFitness << "      average fitness: " << avgFitness << "     crossover ratio: " << crossover_rate * 100 << "%" << std::endl;
-
-    }
+    // a genome's fitness is its average score over several games, each thread playing with its own snake
+    std::function<std::shared_ptr<void> ()> newSnake = [] () -> std::shared_ptr<void> {
+        return std::make_shared<Snake> (8);
+    };
+    std::function<double (pneatm::Genome<myInt, myFloat>&, pneatm::evalContext_t&)> playGames = [&] (pneatm::Genome<myInt, myFloat>& genome, pneatm::evalContext_t& context) -> double {
+        Snake& snake = context.getEnvironment<Snake> ();
 
-    pop->save ("snakePneatm_save");
-
-    // we have to run once again the network to do a speciation to get the last fitter genome
-    for (unsigned int genomeId = 0; genomeId < popSize; genomeId ++) {
         float score = 0.0f;
         for (int g = 0; g < nbGame; g++) {
             snake.reset ();
@@ -95,16 +39,16 @@ int main () {
 
                 // load inputs in the genome's network
                 for (unsigned int i = 0; i < 14; i++) {
-                    pop->template loadInput<myInt> (AI_Inputs [i], i, genomeId);
+                    genome.loadInput<myInt> (AI_Inputs [i], i);
                 }
                 myFloat score = snake.getScore ();
-                pop->template loadInput<myFloat> (score, 14, genomeId);
+                genome.loadInput<myFloat> (score, 14);
 
                 // run the network
-                pop->runNetwork (genomeId);
+                genome.runNetwork ();
 
                 // get output, the movement order to give to the snake
-                myFloat Snake_Inputs = pop->template getOutput<myFloat> (0, genomeId);
+                myFloat Snake_Inputs = genome.getOutput<myFloat> (0);
 
                 // move the snake
                 isFinished = snake.run (Snake_Inputs);
@@ -114,12 +58,37 @@ int main () {
 
             score += snake.getScore ();
 
-            pop->resetMemory (genomeId);
+            genome.resetMemory ();
         }
 
-        // game has ended, we set the score to the genome's fitness
-        pop->setFitness (score / (float) nbGame, genomeId);
+        // games have ended, the score is the genome's fitness
+        return score / (float) nbGame;
+    };
+
+    double bestFitness = 0.0;
+    while (bestFitness < 2500.0 && pop->getGeneration () < 300) { // while goal is not reach
+        std::cout << "generation " << pop->getGeneration () << std::endl;
+
+        // every genome plays, in parallel
+        pop->evaluate (playGames, 0, newSnake);
+
+        // speciation step
+        pop->speciate (5, 100, 0.3);
+        bestFitness = pop->getGenome ().getFitness ();
+        const double avgFitness = pop->getAvgFitness ();
+
+        // build the next generation
+        const double crossover_rate = 0.8 - 0.8 / (1.0 + (avgFitness / 350.0) * (avgFitness / 350.0));
+        pop->buildNextGen (paramsMap, true, crossover_rate);
+
+        std::cout << "best fitness: " << bestFitness << "      average fitness: " << avgFitness << "     crossover ratio: " << crossover_rate * 100 << "%" << std::endl;
+
     }
+
+    pop->save ("snakePneatm_save");
+
+    // we have to run once again the network to do a speciation to get the last fitter genome
+    pop->evaluate (playGames, 0, newSnake);
     pop->speciate (5, 100, 0.3);
 
     // print info and draw genome's network
@@ -80,6 +80,8 @@ class Connection {
 	friend class Population;
 	template <typename... Args>
 	friend class Species;
+	friend struct geneArrays;
+	friend struct connectionGraph;
 };
 
 }
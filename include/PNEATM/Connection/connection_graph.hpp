@@ -0,0 +1,127 @@
+#ifndef CONNECTION_GRAPH_HPP
+#define CONNECTION_GRAPH_HPP
+
+#include <PNEATM/Connection/connection.hpp>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace pneatm {
+
+/**
+ * @brief Structure indexing the connections of a genome by their nodes.
+ *
+ * The `connectionGraph` struct describes the same connections as a genome's map, enabled or not: the connections leaving and entering each node,
+ * and the connection linking each (input node, output node, recurrency) triplet. The graph is therefore walked in a time linear in its size,
+ * and a connection is found in constant time, rather than by scanning every connection.
+ */
+typedef struct connectionGraph {
+    /**
+     * @brief The IDs of the connections leaving each node, by node ID.
+     */
+    std::vector<std::vector<unsigned int>> outConns;
+
+    /**
+     * @brief The IDs of the connections entering each node, by node ID.
+     */
+    std::vector<std::vector<unsigned int>> inConns;
+
+    /**
+     * @brief Build the graph from connections whose IDs go from 0 to their number minus one, while keeping the allocated memory.
+     * @param connections The connections.
+     * @param nbNodes The number of nodes.
+     */
+    void build (const std::unordered_map<unsigned int, Connection>& connections, size_t nbNodes) {
+        for (std::vector<unsigned int>& conns : outConns) {
+            conns.clear ();
+        }
+        for (std::vector<unsigned int>& conns : inConns) {
+            conns.clear ();
+        }
+        outConns.resize (nbNodes);
+        inConns.resize (nbNodes);
+        keys.clear ();
+        keys.reserve (connections.size ());
+        for (unsigned int connId = 0; connId < (unsigned int) connections.size (); connId++) {
+            add (connections.at (connId));
+        }
+    }
+
+    /**
+     * @brief Add a connection to the graph.
+     * @param conn The connection.
+     */
+    void add (const Connection& conn) {
+        const size_t nbNodes = (size_t) std::max (conn.inNodeId, conn.outNodeId) + 1;
+        if (outConns.size () < nbNodes) {
+            outConns.resize (nbNodes);
+            inConns.resize (nbNodes);
+        }
+        outConns [conn.inNodeId].push_back (conn.id);
+        inConns [conn.outNodeId].push_back (conn.id);
+        keys.insert (std::make_pair (connKey_t {conn.inNodeId, conn.outNodeId, conn.inNodeRecu}, conn.id));  // the first connection is kept if there is already one
+    }
+
+    /**
+     * @brief Get the connections leaving a node.
+     * @param nodeId The node's ID.
+     * @return The IDs of the connections.
+     */
+    const std::vector<unsigned int>& outgoing (unsigned int nodeId) const {
+        return nodeId < outConns.size () ? outConns [nodeId] : none;
+    }
+
+    /**
+     * @brief Get the connections entering a node.
+     * @param nodeId The node's ID.
+     * @return The IDs of the connections.
+     */
+    const std::vector<unsigned int>& incoming (unsigned int nodeId) const {
+        return nodeId < inConns.size () ? inConns [nodeId] : none;
+    }
+
+    /**
+     * @brief Find the connection linking two nodes.
+     * @param inNodeId The ID of the input node.
+     * @param outNodeId The ID of the output node.
+     * @param inNodeRecu The recurrency of the input node.
+     * @return The ID of the connection, -1 if there is none.
+     */
+    int find (unsigned int inNodeId, unsigned int outNodeId, unsigned int inNodeRecu) const {
+        const std::unordered_map<connKey_t, unsigned int, connKeyHash_t>::const_iterator it = keys.find (connKey_t {inNodeId, outNodeId, inNodeRecu});
+        return it != keys.end () ? (int) it->second : -1;
+    }
+
+private:
+    typedef struct connKey {
+        unsigned int inNodeId;
+        unsigned int outNodeId;
+        unsigned int inNodeRecu;
+
+        bool operator== (const connKey& other) const {
+            return inNodeId == other.inNodeId && outNodeId == other.outNodeId && inNodeRecu == other.inNodeRecu;
+        }
+    } connKey_t;
+
+    typedef struct connKeyHash {
+        size_t operator() (const connKey_t& key) const {
+            // the finalizer of splitmix64
+            uint64_t x = ((uint64_t) key.inNodeId << 32 | key.outNodeId) ^ ((uint64_t) key.inNodeRecu * 0x9E3779B97F4A7C15ull);
+            x ^= x >> 30;
+            x *= 0xBF58476D1CE4E5B9ull;
+            x ^= x >> 27;
+            x *= 0x94D049BB133111EBull;
+            x ^= x >> 31;
+            return (size_t) x;
+        }
+    } connKeyHash_t;
+
+    std::unordered_map<connKey_t, unsigned int, connKeyHash_t> keys;
+    std::vector<unsigned int> none;    // the connections of a node added after the last connection
+} connectionGraph_t;
+
+}
+
+#endif	// CONNECTION_GRAPH_HPP
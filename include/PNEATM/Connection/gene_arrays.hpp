@@ -0,0 +1,157 @@
+#ifndef GENE_ARRAYS_HPP
+#define GENE_ARRAYS_HPP
+
+#include <PNEATM/Connection/connection.hpp>
+#include <PNEATM/utils.hpp>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace pneatm {
+
+/**
+ * @brief Structure representing the connections of a genome as arrays sorted by innovation ID.
+ *
+ * The `geneArrays` struct is a structure of arrays describing the same connections as a genome's map, sorted by innovation ID
+ * (then by connection ID, a genome being able to hold several connections with the same innovation ID).
+ * Two genomes' genes are therefore aligned by a single merge pass over their arrays, or by word-wise operations over their bitsets of enabled innovation IDs.
+ */
+typedef struct geneArrays {
+    /**
+     * @brief Innovation ID of each gene, in increasing order.
+     */
+    std::vector<unsigned int> innovIds;
+
+    /**
+     * @brief Connection's ID of each gene.
+     */
+    std::vector<unsigned int> connIds;
+
+    /**
+     * @brief Weight of each gene.
+     */
+    std::vector<double> weights;
+
+    /**
+     * @brief Whether each gene is enabled (1) or disabled (0).
+     */
+    std::vector<unsigned char> enabled;
+
+    /**
+     * @brief Number of enabled genes.
+     */
+    size_t nbEnabled;
+
+    /**
+     * @brief Highest innovation ID of the enabled genes, 0 if there is none.
+     */
+    unsigned int maxEnabledInnovId;
+
+    /**
+     * @brief Bitset of the innovation IDs of the enabled genes, bit `i % 64` of word `i / 64` standing for innovation ID i, up to `maxEnabledInnovId`.
+     */
+    std::vector<uint64_t> enabledBits;
+
+    /**
+     * @brief Number of bits set in `enabledBits` before each of its words.
+     */
+    std::vector<unsigned int> enabledRanks;
+
+    /**
+     * @brief Index in the arrays of each enabled gene, in increasing order: the n-th bit set in `enabledBits` stands for the gene `enabledGenes [n]`.
+     */
+    std::vector<unsigned int> enabledGenes;
+
+    /**
+     * @brief Whether no two enabled genes share an innovation ID, in which case `enabledBits` describes the enabled genes exactly.
+     */
+    bool enabledUnique;
+
+    /**
+     * @brief Constructor of geneArrays
+     */
+    geneArrays () :
+        nbEnabled (0),
+        maxEnabledInnovId (0),
+        enabledUnique (true)
+    {};
+
+    /**
+     * @brief Get the number of genes.
+     * @return The number of genes.
+     */
+    size_t size () const {
+        return innovIds.size ();
+    }
+
+    /**
+     * @brief Build the arrays from connections whose IDs go from 0 to their number minus one, while keeping the allocated memory.
+     * @param connections The connections.
+     */
+    void build (const std::unordered_map<unsigned int, Connection>& connections) {
+        const unsigned int n = (unsigned int) connections.size ();
+
+        // sort the connections' IDs by innovation ID, the stable sort keeping the connections with the same one by ID
+        connIds.resize (n);
+        innovIds.resize (n);
+        for (unsigned int connId = 0; connId < n; connId++) {
+            connIds [connId] = connId;
+            innovIds [connId] = connections.at (connId).innovId;
+        }
+        std::stable_sort (connIds.begin (), connIds.end (), [&] (unsigned int id1, unsigned int id2) {
+            return innovIds [id1] < innovIds [id2];
+        });
+
+        weights.resize (n);
+        enabled.resize (n);
+        nbEnabled = 0;
+        maxEnabledInnovId = 0;
+        for (unsigned int k = 0; k < n; k++) {
+            const Connection& conn = connections.at (connIds [k]);
+            innovIds [k] = conn.innovId;
+            weights [k] = conn.weight;
+            enabled [k] = conn.enabled ? 1 : 0;
+            if (conn.enabled) {
+                nbEnabled ++;
+                maxEnabledInnovId = std::max (maxEnabledInnovId, conn.innovId);
+            }
+        }
+
+        // the bitset of the enabled innovation IDs, and the rank of each of its words
+        enabledBits.assign (nbEnabled > 0 ? (size_t) maxEnabledInnovId / 64 + 1 : 0, 0);
+        enabledGenes.clear ();
+        enabledUnique = true;
+        for (unsigned int k = 0; k < n; k++) {
+            if (enabled [k]) {
+                const uint64_t bit = (uint64_t) 1 << (innovIds [k] % 64);
+                if (enabledBits [innovIds [k] / 64] & bit) {
+                    enabledUnique = false;
+                }
+                enabledBits [innovIds [k] / 64] |= bit;
+                enabledGenes.push_back (k);
+            }
+        }
+        enabledRanks.resize (enabledBits.size ());
+        unsigned int rank = 0;
+        for (size_t w = 0; w < enabledBits.size (); w++) {
+            enabledRanks [w] = rank;
+            rank += Pop_Count (enabledBits [w]);
+        }
+    }
+
+    /**
+     * @brief Get the index in the arrays of the enabled gene with a given innovation ID, which must be set in `enabledBits` while `enabledUnique` is true.
+     * @param innovId The innovation ID.
+     * @return The index of the gene.
+     */
+    unsigned int enabledGene (unsigned int innovId) const {
+        const uint64_t below = ((uint64_t) 1 << (innovId % 64)) - 1;
+        return enabledGenes [enabledRanks [innovId / 64] + Pop_Count (enabledBits [innovId / 64] & below)];
+    }
+} geneArrays_t;
+
+}
+
+#endif	// GENE_ARRAYS_HPP
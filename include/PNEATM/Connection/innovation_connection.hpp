@@ -3,6 +3,12 @@
 
 #include <PNEATM/utils.hpp>
 #include <vector>
+#include <array>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include <cstring>
 #include <fstream>
@@ -16,17 +22,46 @@ namespace pneatm {
  * It keeps track of the innovation IDs assigned to different connections based on input and output node
  * innovation IDs and the connection's recurrency. It also provides a method to retrieve a unique
  * innovation ID.
+ *
+ * `getInnovId` can be called from several threads at once: the registry is split into shards, each one guarded by its own
+ * mutex, and the IDs are taken from an atomic counter. The same connection always gets the same innovation ID, whichever thread asks first.
+ * As the IDs then depend on the order the threads ask them in, `renumber` gives them back an order which does not.
  */
 typedef struct innovationConn {
     /**
-     * @brief 3D array that represent the connection's innovation ids in the (*input node*, *output node*, *connection recurrency level*) space.
+     * @brief The number of shards: two lookups falling in different shards never wait for each other.
+     */
+    static constexpr unsigned int N_SHARDS = 16;
+
+    /**
+     * @brief A part of the registry, guarded by its own mutex.
+     */
+    typedef struct shard {
+        /**
+         * @brief The mutex guarding the shard.
+         */
+        std::mutex mutex;
+
+        /**
+         * @brief 3D array that represent the connection's innovation ids in the (*input node*, *output node*, *connection recurrency level*) space.
+         */
+        std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, unsigned int>>> connectionIds;
+
+        /**
+         * @brief The connections added since the last renumbering, as (*input node*, *output node*, *connection recurrency level*).
+         */
+        std::vector<std::array<unsigned int, 3>> added;
+    } shard_t;
+
+    /**
+     * @brief The shards of the registry, a connection being stored in the shard `Shard (inNodeInnovId, outNodeInnovId, inNodeRecu)`.
      */
-    std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, unsigned int>>> connectionIds;
+    std::array<shard_t, N_SHARDS> shards;
 
     /**
      * @brief The next innovation id to give.
      */
-    unsigned int N_connectionId;
+    std::atomic<unsigned int> N_connectionId;
 
     /**
      * @brief Constructor of innovationConn
@@ -37,19 +72,77 @@ typedef struct innovationConn {
     {};
 
     /**
-     * @brief Get the innovation ID for a connection.
+     * @brief Get the innovation ID for a connection. It is thread-safe.
      * @param inNodeInnovId The innovation ID of the input node.
      * @param outNodeInnovId The innovation ID of the output node.
      * @param inNodeRecu The recurrency of the input node.
      * @return The innovation ID for the specified connection.
      */
     unsigned int getInnovId (unsigned int inNodeInnovId, unsigned int outNodeInnovId, unsigned int inNodeRecu) {
-        if (connectionIds [inNodeInnovId][outNodeInnovId].find (inNodeRecu) == connectionIds [inNodeInnovId][outNodeInnovId].end ()) {
-            // the node isn't existing yet
-            connectionIds [inNodeInnovId][outNodeInnovId][inNodeRecu] = N_connectionId;
-            N_connectionId ++;
+        shard_t& shard = shards [Shard (inNodeInnovId, outNodeInnovId, inNodeRecu)];
+        std::lock_guard<std::mutex> lock (shard.mutex);
+        std::unordered_map<unsigned int, unsigned int>& ids = shard.connectionIds [inNodeInnovId][outNodeInnovId];
+        std::unordered_map<unsigned int, unsigned int>::iterator it = ids.find (inNodeRecu);
+        if (it == ids.end ()) {
+            // the connection isn't existing yet
+            it = ids.emplace (inNodeRecu, N_connectionId.fetch_add (1)).first;
+            shard.added.push_back ({inNodeInnovId, outNodeInnovId, inNodeRecu});
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Renumber the innovation IDs given from `firstId`, so that they do not depend on the order they have been asked in. It is not thread-safe.
+     * @param firstId The first ID to renumber.
+     * @param order The IDs from `firstId` in their new order; the ones missing are put after, sorted by connection.
+     * @param firstNodeId The first node's innovation ID that has been renumbered.
+     * @param nodeRemap The new node's innovation IDs, `nodeRemap [id - firstNodeId]` being the one of `id`.
+     * @return The new IDs, `remap [id - firstId]` being the one of `id`.
+     */
+    std::vector<unsigned int> renumber (unsigned int firstId, const std::vector<unsigned int>& order, unsigned int firstNodeId, const std::vector<unsigned int>& nodeRemap) {
+        typedef struct entry {
+            std::array<unsigned int, 3> key;
+            unsigned int id;
+        } entry_t;
+
+        // take the entries to renumber out of the shards, with their key's nodes renumbered
+        std::vector<entry_t> entries;
+        for (shard_t& shard : shards) {
+            for (const std::array<unsigned int, 3>& key : shard.added) {
+                std::unordered_map<unsigned int, unsigned int>& ids = shard.connectionIds [key [0]][key [1]];
+                const unsigned int id = ids [key [2]];
+                if (id >= firstId) {
+                    ids.erase (key [2]);
+                    entry_t entry = {key, id};
+                    for (unsigned int k = 0; k < 2; k++) {
+                        if (entry.key [k] >= firstNodeId && entry.key [k] - firstNodeId < nodeRemap.size ()) {
+                            entry.key [k] = nodeRemap [entry.key [k] - firstNodeId];
+                        }
+                    }
+                    entries.push_back (entry);
+                }
+            }
+            shard.added.clear ();
+        }
+
+        std::vector<unsigned int> remap (N_connectionId - firstId, UINT_MAX);
+        unsigned int nextId = firstId;
+        for (unsigned int id : order) {
+            if (remap [id - firstId] == UINT_MAX) {
+                remap [id - firstId] = nextId ++;
+            }
+        }
+        std::sort (entries.begin (), entries.end (), [] (const entry_t& entry1, const entry_t& entry2) {
+            return entry1.key < entry2.key;
+        });
+        for (entry_t& entry : entries) {
+            if (remap [entry.id - firstId] == UINT_MAX) {
+                remap [entry.id - firstId] = nextId ++;
+            }
+            entry.id = remap [entry.id - firstId];
+            shards [Shard (entry.key [0], entry.key [1], entry.key [2])].connectionIds [entry.key [0]][entry.key [1]][entry.key [2]] = entry.id;
         }
-        return connectionIds [inNodeInnovId][outNodeInnovId][inNodeRecu];
+        return remap;
     }
 
     /**
@@ -65,8 +158,17 @@ typedef struct innovationConn {
      * @param outFile The output file stream to which the innovationConn instance will be written.
      */
     void serialize (std::ofstream& outFile) const {
+        // the shards are merged, so that the file does not depend on the sharding
+        std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, unsigned int>>> connectionIds;
+        for (const shard_t& shard : shards) {
+            for (const auto& in : shard.connectionIds) {
+                for (const auto& out : in.second) {
+                    connectionIds [in.first][out.first].insert (out.second.begin (), out.second.end ());
+                }
+            }
+        }
         Serialize (connectionIds, outFile);
-        Serialize (N_connectionId, outFile);
+        Serialize (N_connectionId.load (), outFile);
     }
 
     /**
@@ -74,8 +176,33 @@ typedef struct innovationConn {
      * @param inFile The input file stream from which the innovationConn instance will be read.
      */
     void deserialize (std::ifstream& inFile) {
+        std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, unsigned int>>> connectionIds;
         Deserialize (connectionIds, inFile);
-        Deserialize (N_connectionId, inFile);
+        for (shard_t& shard : shards) {
+            shard.connectionIds.clear ();
+            shard.added.clear ();
+        }
+        for (const auto& in : connectionIds) {
+            for (const auto& out : in.second) {
+                for (const std::pair<const unsigned int, unsigned int>& recu : out.second) {
+                    shards [Shard (in.first, out.first, recu.first)].connectionIds [in.first][out.first][recu.first] = recu.second;
+                }
+            }
+        }
+        unsigned int nextId;
+        Deserialize (nextId, inFile);
+        N_connectionId = nextId;
+    }
+
+    /**
+     * @brief Get the shard storing a connection.
+     * @param inNodeInnovId The innovation ID of the input node.
+     * @param outNodeInnovId The innovation ID of the output node.
+     * @param inNodeRecu The recurrency of the input node.
+     * @return The index of the shard.
+     */
+    static unsigned int Shard (unsigned int inNodeInnovId, unsigned int outNodeInnovId, unsigned int inNodeRecu) {
+        return ((inNodeInnovId * 73856093u) ^ (outNodeInnovId * 19349663u) ^ (inNodeRecu * 83492791u)) % N_SHARDS;
     }
 } innovationConn_t;
 
@@ -2,11 +2,15 @@
 #define ACTIVATION_FUNCTION_HPP
 
 #include <PNEATM/Node/Activation_Function/activation_function_base.hpp>
+#include <PNEATM/Node/Activation_Function/activation_registry.hpp>
+#include <PNEATM/Node/Activation_Function/activation_kernels.hpp>
 #include <PNEATM/utils.hpp>
 #include <iostream>
 #include <cstring>
 #include <memory>
 #include <fstream>
+#include <type_traits>
+#include <cmath>
 
 
 /* HEADER */
@@ -22,6 +26,9 @@ namespace pneatm {
  * The `ActivationFn` class is a template class representing an activation function in a neural network.
  * It is derived from the `ActivationFnBase` abstract base class and provides implementations
  * for the virtual functions defined in the base class.
+ * The activation function only stores its parameters and a shared pointer to its definition (see ActivationRegistry), which
+ * is shared with all its clones. Setting one of its functions on an activation function which does not own its definition, or shares it,
+ * copies the definition into a new one of its own first, so that it never changes the definition of its prototype nor of its clones.
  *
  * @tparam T_in The input data type for the activation function.
  * @tparam T_out The output data type for the activation function.
@@ -32,8 +39,8 @@ class ActivationFn : public ActivationFnBase {
 		/**
 		 * @brief Constructor for the ActivationFn class.
 		 *
-		 * The constructor initalized the activation function's parameters to their default values and initialized
-		 * mutation and printing functions to functions that does nothing.
+		 * The constructor initalized the activation function's parameters to their default values and uses the default definition
+		 * whose mutation and printing functions do nothing. It does not register anything.
 		 */
 		ActivationFn ();
 
@@ -48,6 +55,39 @@ class ActivationFn : public ActivationFnBase {
 		 */
         void setFunction (void* func) override;
 
+		/**
+		 * @brief Set a built-in kernel as the activation function.
+		 *
+		 * The kernels are computed in float if both T_in and T_out are float, in double else. A parameterised kernel computes
+		 * kernel (alpha * (x - beta)) using the `alpha` and `beta` members of the activation function's parameters.
+		 *
+		 * @param kernel The built-in kernel.
+		 * @param precision The approximation level, see ActivationKernels for the maximum errors. (default is EXACT)
+		 * @param parameterised True to use the parameters's `alpha` and `beta`. (default is false)
+		 * @return True if the kernel is supported (both T_in and T_out are arithmetic types and, if parameterised, the parameters have `alpha` and `beta` members), false else.
+		 */
+        bool setFunction (activationKernel kernel, activationPrecision precision = EXACT, bool parameterised = false) override;
+
+		/**
+		 * @brief Get the built-in kernel of the activation function.
+		 * @return The built-in kernel, CUSTOM if the activation function has been set with setFunction (void*).
+		 */
+        activationKernel getKernel () const override;
+
+		/**
+		 * @brief Get the approximation level of the built-in kernel.
+		 * @return The approximation level.
+		 */
+        activationPrecision getPrecision () const override;
+
+		/**
+		 * @brief Get the scaling applied to the inputs of a parameterised built-in kernel: kernel (alpha * (x - beta)).
+		 * @param alpha Set to the scale, 1 if the kernel is not parameterised.
+		 * @param beta Set to the offset, 0 if the kernel is not parameterised.
+		 * @return True if the kernel is parameterised, false else.
+		 */
+        bool getScaling (double& alpha, double& beta) const override;
+
 		/**
 		 * @brief Set the mutation function aka the function used to mutate the activation function's parameters.
 		 * @param func A pointer to the mutation function to be set.
@@ -67,16 +107,24 @@ class ActivationFn : public ActivationFnBase {
         void setParameters (activationFnParams_t*& parameters) override;
 
 		/**
-		 * @brief Create a clone of the class: clone the activation function, the mutation function, the printing function and the parameters (optionally).
+		 * @brief Create a clone of the class: share the activation function's definition and clone the parameters (optionally).
 		 * @param preserveParameters True if the parameters should be cloned, False else. (default is true)
 		 * @return A unique pointer to the cloned node.
 		 */
-		std::unique_ptr<ActivationFnBase> clone (bool preserveParameters = true) override;
+		std::unique_ptr<ActivationFnBase> clone (bool preserveParameters = true) const override;
 
 		/**
 		 * @brief Process the activation function to compute its output value.
 		 */
-		T_out process (const T_in& value);
+		T_out process (const T_in& value) const;
+
+		/**
+		 * @brief Process the activation function over an array of values. Built-in kernels are applied to the whole array at once.
+		 * @param values The input values.
+		 * @param outputs The output values.
+		 * @param n The number of values.
+		 */
+		void process (const T_in* values, T_out* outputs, size_t n) const;
 
 		/**
 		 * @brief Mutate the activatoin function's parameters.
@@ -103,7 +151,20 @@ class ActivationFn : public ActivationFnBase {
 		void deserialize (std::ifstream& inFile) override;
 
     private:
-		std::function<T_out (T_in, activationFnParams_t*)> processFn;
+		std::shared_ptr<typename ActivationRegistry<T_in, T_out>::definition_t> definition;
+		bool ownsDefinition;	// the definition has been added by this activation function, rather than shared with its prototype
+
+		static constexpr bool arithmetic = std::is_arithmetic<T_in>::value && std::is_arithmetic<T_out>::value;
+
+		typename ActivationRegistry<T_in, T_out>::definition_t& Define ();
+		T_out Process (const T_in& value, std::true_type) const;
+		T_out Process (const T_in& value, std::false_type) const;
+		void Process (const T_in* values, T_out* outputs, size_t n, std::true_type) const;
+		void Process (const T_in* values, T_out* outputs, size_t n, std::false_type) const;
+
+		template <typename P>
+		static auto Scaling (const P* parameters, double& alpha, double& beta, int) -> decltype (void (parameters->alpha - parameters->beta), true);
+		static bool Scaling (const void* parameters, double& alpha, double& beta, long);
 
 };
 
@@ -115,35 +176,67 @@ class ActivationFn : public ActivationFnBase {
 using namespace pneatm;
 
 template <typename T_in, typename T_out>
-ActivationFn<T_in, T_out>::ActivationFn () {
-	mutationFn = [=] (activationFnParams_t* params, double fitness) {
-		// default mutation function do nothing
-		UNUSED (params);
-		UNUSED (fitness);
-	};
-
-	printingFn = [=] (activationFnParams_t* params, std::string prefix) {
-		// default printing function do nothing
-		UNUSED (params);
-		UNUSED (prefix);
-	};
-
+ActivationFn<T_in, T_out>::ActivationFn () :
+	definition (ActivationRegistry<T_in, T_out>::getDefault ()),
+	ownsDefinition (false)
+{
 	params = std::make_unique<activationFnParams_t> ();
 }
 
+template <typename T_in, typename T_out>
+typename ActivationRegistry<T_in, T_out>::definition_t& ActivationFn<T_in, T_out>::Define () {
+	if (!ownsDefinition || definition.use_count () > 1) {
+		// the definition is the default one, the prototype's one or is shared with clones, we need our own, copied from it
+		definition = ActivationRegistry<T_in, T_out>::add (*definition);
+		ownsDefinition = true;
+	}
+	return *definition;
+}
+
 template <typename T_in, typename T_out>
 void ActivationFn<T_in, T_out>::setFunction (void* func) {
-	processFn = *static_cast<std::function<T_out (T_in, activationFnParams_t*)>*> (func);
+	typename ActivationRegistry<T_in, T_out>::definition_t& defined = Define ();
+	defined.processFn = *static_cast<std::function<T_out (T_in, activationFnParams_t*)>*> (func);
+	defined.kernel = CUSTOM;
+}
+
+template <typename T_in, typename T_out>
+bool ActivationFn<T_in, T_out>::setFunction (activationKernel kernel, activationPrecision precision, bool parameterised) {
+	double alpha, beta;
+	if (!arithmetic && kernel != CUSTOM) return false;
+	if (parameterised && !Scaling (params.get (), alpha, beta, 0)) return false;
+	typename ActivationRegistry<T_in, T_out>::definition_t& defined = Define ();
+	defined.kernel = kernel;
+	defined.precision = precision;
+	defined.parameterised = parameterised;
+	return true;
+}
+
+template <typename T_in, typename T_out>
+activationKernel ActivationFn<T_in, T_out>::getKernel () const {
+	return definition->kernel;
+}
+
+template <typename T_in, typename T_out>
+activationPrecision ActivationFn<T_in, T_out>::getPrecision () const {
+	return definition->precision;
+}
+
+template <typename T_in, typename T_out>
+bool ActivationFn<T_in, T_out>::getScaling (double& alpha, double& beta) const {
+	alpha = 1.0;
+	beta = 0.0;
+	return definition->parameterised && Scaling (params.get (), alpha, beta, 0);
 }
 
 template <typename T_in, typename T_out>
 void ActivationFn<T_in, T_out>::setMutationFunction (const std::function<void (activationFnParams_t*, double)>& func) {
-	mutationFn = func;
+	Define ().mutationFn = func;
 }
 
 template <typename T_in, typename T_out>
 void ActivationFn<T_in, T_out>::setPrintingFunction (const std::function<void (activationFnParams_t*, std::string)>& func) {
-	printingFn = func;
+	Define ().printingFn = func;
 }
 
 template <typename T_in, typename T_out>
@@ -152,32 +245,90 @@ void ActivationFn<T_in, T_out>::setParameters (activationFnParams_t*& parameters
 }
 
 template <typename T_in, typename T_out>
-std::unique_ptr<ActivationFnBase> ActivationFn<T_in, T_out>::clone (bool preserveParameters) {
-	std::unique_ptr<ActivationFnBase> actfun =  std::make_unique<ActivationFn<T_in, T_out>> ();
+std::unique_ptr<ActivationFnBase> ActivationFn<T_in, T_out>::clone (bool preserveParameters) const {
+	std::unique_ptr<ActivationFn<T_in, T_out>> actfun = std::make_unique<ActivationFn<T_in, T_out>> ();
 
 	if (preserveParameters) {
 		*actfun->params = *params;
 	}
-	actfun->setFunction (static_cast<void*> (&processFn));
-	actfun->mutationFn = mutationFn;
-	actfun->printingFn = printingFn;
+	actfun->definition = definition;	// the definition is shared, nothing else to copy
 
 	return actfun;
 }
 
 template <typename T_in, typename T_out>
-T_out ActivationFn<T_in, T_out>::process (const T_in& value) {
-	return processFn (value, params.get ());
+T_out ActivationFn<T_in, T_out>::process (const T_in& value) const {
+	return Process (value, std::integral_constant<bool, arithmetic> ());
+}
+
+template <typename T_in, typename T_out>
+T_out ActivationFn<T_in, T_out>::Process (const T_in& value, std::true_type) const {
+	if (definition->kernel == CUSTOM) {
+		return definition->processFn (value, params.get ());
+	}
+	T_out output;
+	Process (&value, &output, 1, std::true_type ());
+	return output;
+}
+
+template <typename T_in, typename T_out>
+T_out ActivationFn<T_in, T_out>::Process (const T_in& value, std::false_type) const {
+	return definition->processFn (value, params.get ());
+}
+
+template <typename T_in, typename T_out>
+void ActivationFn<T_in, T_out>::process (const T_in* values, T_out* outputs, size_t n) const {
+	Process (values, outputs, n, std::integral_constant<bool, arithmetic> ());
+}
+
+template <typename T_in, typename T_out>
+void ActivationFn<T_in, T_out>::Process (const T_in* values, T_out* outputs, size_t n, std::true_type) const {
+	typedef typename std::conditional<std::is_same<T_in, float>::value && std::is_same<T_out, float>::value, float, double>::type K;
+	if (definition->kernel == CUSTOM) {
+		Process (values, outputs, n, std::false_type ());
+		return;
+	}
+	double alpha = 1.0;
+	double beta = 0.0;
+	if (definition->parameterised) {
+		Scaling (params.get (), alpha, beta, 0);
+	}
+	ActivationKernels<K>::map (definition->kernel, definition->precision, values, outputs, n, static_cast<K> (alpha), static_cast<K> (beta));
+}
+
+template <typename T_in, typename T_out>
+void ActivationFn<T_in, T_out>::Process (const T_in* values, T_out* outputs, size_t n, std::false_type) const {
+	const std::function<T_out (T_in, activationFnParams_t*)>& processFn = definition->processFn;
+	for (size_t i = 0; i < n; i++) {
+		outputs [i] = processFn (values [i], params.get ());
+	}
+}
+
+template <typename T_in, typename T_out>
+template <typename P>
+auto ActivationFn<T_in, T_out>::Scaling (const P* parameters, double& alpha, double& beta, int) -> decltype (void (parameters->alpha - parameters->beta), true) {
+	alpha = static_cast<double> (parameters->alpha);
+	beta = static_cast<double> (parameters->beta);
+	return true;
+}
+
+template <typename T_in, typename T_out>
+bool ActivationFn<T_in, T_out>::Scaling (const void* parameters, double& alpha, double& beta, long) {
+	// the parameters have no alpha nor beta
+	UNUSED (parameters);
+	UNUSED (alpha);
+	UNUSED (beta);
+	return false;
 }
 
 template <typename T_in, typename T_out>
 void ActivationFn<T_in, T_out>::mutate (double fitness) {
-	mutationFn (params.get (), fitness);
+	definition->mutationFn (params.get (), fitness);
 }
 
 template <typename T_in, typename T_out>
 void ActivationFn<T_in, T_out>::print (const std::string& prefix) const {
-	printingFn (params.get (), prefix);
+	definition->printingFn (params.get (), prefix);
 }
 
 template <typename T_in, typename T_out>
@@ -11,6 +11,33 @@ typedef struct activationFnParams activationFnParams_t;
 
 namespace pneatm {
 
+/**
+ * @brief Enumeration of the built-in activation kernels.
+ *
+ * Built-in kernels are evaluated inline (without going through a std::function) when both T_in and T_out are arithmetic types.
+ * CUSTOM means that the activation function set with setFunction (void*) is used. CLAMP clamps to [-1, 1].
+ */
+enum activationKernel {
+	CUSTOM,
+	IDENTITY,
+	SIGMOID,
+	TANH,
+	RELU,
+	GAUSSIAN,
+	SIN,
+	ABS,
+	CLAMP
+};
+
+/**
+ * @brief Enumeration of the built-in kernels's approximation levels. The maximum errors are documented in ActivationKernels.
+ */
+enum activationPrecision {
+	EXACT,
+	FAST,
+	FASTEST
+};
+
 /**
  * @brief Abstract base class representing a generic node's activation function in a neural network.
  *
@@ -30,6 +57,35 @@ class ActivationFnBase {
          */
         virtual void setFunction (void* func) = 0;
 
+        /**
+         * @brief Sets a built-in kernel as the activation function implementation.
+         * @param kernel The built-in kernel.
+         * @param precision The approximation level. (default is EXACT)
+         * @param parameterised True to apply the kernel to alpha * (x - beta), alpha and beta being members of the parameters. (default is false)
+         * @return True if the kernel is supported by the input and output types (they have to be arithmetic types) and by the parameters, false else.
+         */
+        virtual bool setFunction (activationKernel kernel, activationPrecision precision = EXACT, bool parameterised = false) = 0;
+
+        /**
+         * @brief Gets the built-in kernel of the activation function.
+         * @return The built-in kernel, CUSTOM if the activation function has been set with setFunction (void*).
+         */
+        virtual activationKernel getKernel () const = 0;
+
+        /**
+         * @brief Gets the approximation level of the built-in kernel.
+         * @return The approximation level.
+         */
+        virtual activationPrecision getPrecision () const = 0;
+
+        /**
+         * @brief Gets the scaling applied to the inputs of a parameterised built-in kernel: kernel (alpha * (x - beta)).
+         * @param alpha Set to the scale, 1 if the kernel is not parameterised.
+         * @param beta Set to the offset, 0 if the kernel is not parameterised.
+         * @return True if the kernel is parameterised, false else.
+         */
+        virtual bool getScaling (double& alpha, double& beta) const = 0;
+
         /**
          * @brief Sets the mutation function for the activation function's parameters.
          * @param func The mutation function that modifies the activation function's parameters based on the fitness value.
@@ -53,7 +109,7 @@ class ActivationFnBase {
          * @param preserveParameters Set to true if you want to copy the parameters of the current function to the new one, else they are set by the default constructor. (default is true)
          * @return A unique_ptr to the cloned ActivationFnBase object.
          */
-		virtual std::unique_ptr<ActivationFnBase> clone (bool preserveParameters = true) = 0;
+		virtual std::unique_ptr<ActivationFnBase> clone (bool preserveParameters = true) const = 0;
 
         /**
          * @brief Mutates the activation function based on the provided fitness value.
@@ -85,16 +141,6 @@ class ActivationFnBase {
          */
         std::unique_ptr<activationFnParams_t> params;
 
-        /**
-         * @brief The parameters' mutation function.
-         */
-        std::function<void (activationFnParams_t*, double)> mutationFn;
-
-        /**
-         * @brief The parameters' printing function.
-         */
-        std::function<void (activationFnParams_t*, std::string)> printingFn;
-
     template <typename T_in, typename T_out>
 	friend class ActivationFn;
 
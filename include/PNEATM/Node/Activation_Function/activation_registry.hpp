@@ -0,0 +1,97 @@
+#ifndef ACTIVATION_REGISTRY_HPP
+#define ACTIVATION_REGISTRY_HPP
+
+#include <PNEATM/Node/Activation_Function/activation_function_base.hpp>
+#include <PNEATM/utils.hpp>
+#include <functional>
+#include <memory>
+
+
+/* HEADER */
+
+// Forward declaration
+typedef struct activationFnParams activationFnParams_t;
+
+namespace pneatm {
+
+/**
+ * @brief A template class holding the activation functions's definitions of a (T_in, T_out) pair.
+ *
+ * An activation function is defined once (its kernel or processing function, its mutation function and its printing function) and every
+ * ActivationFn sharing this definition only holds a shared pointer to it: cloning an activation function into a node doesn't copy any std::function.
+ * A definition is copied on write by the activation functions (see `ActivationFn`), is never changed once shared, and is released with the last
+ * activation function using it. The default definition does nothing and is used by activation functions that have not been defined yet.
+ *
+ * @tparam T_in The input data type for the activation functions.
+ * @tparam T_out The output data type for the activation functions.
+ */
+template <typename T_in, typename T_out>
+class ActivationRegistry {
+	public:
+		/**
+		 * @brief A struct holding an activation function's definition.
+		 */
+		typedef struct definition {
+			activationKernel kernel;	// built-in kernel, CUSTOM to use processFn
+			activationPrecision precision;
+			bool parameterised;	// built-in kernel applied to alpha * (x - beta)
+			std::function<T_out (T_in, activationFnParams_t*)> processFn;
+			std::function<void (activationFnParams_t*, double)> mutationFn;
+			std::function<void (activationFnParams_t*, std::string)> printingFn;
+		} definition_t;
+
+		/**
+		 * @brief Create a new definition.
+		 * @param definition The definition to copy.
+		 * @return A pointer to the new definition, which is released with the last copy of the pointer.
+		 */
+		static std::shared_ptr<definition_t> add (const definition_t& definition);
+
+		/**
+		 * @brief Get the default definition, whose mutation and printing functions do nothing. It is never released.
+		 * @return A pointer to the default definition.
+		 */
+		static const std::shared_ptr<definition_t>& getDefault ();
+
+	private:
+		static definition_t Default ();
+};
+
+}
+
+
+/* IMPLEMENTATIONS */
+
+using namespace pneatm;
+
+template <typename T_in, typename T_out>
+std::shared_ptr<typename ActivationRegistry<T_in, T_out>::definition_t> ActivationRegistry<T_in, T_out>::add (const definition_t& definition) {
+	return std::make_shared<definition_t> (definition);
+}
+
+template <typename T_in, typename T_out>
+const std::shared_ptr<typename ActivationRegistry<T_in, T_out>::definition_t>& ActivationRegistry<T_in, T_out>::getDefault () {
+	static const std::shared_ptr<definition_t> definition = std::make_shared<definition_t> (Default ());
+	return definition;
+}
+
+template <typename T_in, typename T_out>
+typename ActivationRegistry<T_in, T_out>::definition_t ActivationRegistry<T_in, T_out>::Default () {
+	definition_t definition;
+	definition.kernel = CUSTOM;
+	definition.precision = EXACT;
+	definition.parameterised = false;
+	definition.mutationFn = [] (activationFnParams_t* params, double fitness) {
+		// default mutation function do nothing
+		UNUSED (params);
+		UNUSED (fitness);
+	};
+	definition.printingFn = [] (activationFnParams_t* params, std::string prefix) {
+		// default printing function do nothing
+		UNUSED (params);
+		UNUSED (prefix);
+	};
+	return definition;
+}
+
+#endif	// ACTIVATION_REGISTRY_HPP
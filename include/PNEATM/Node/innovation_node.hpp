@@ -3,7 +3,12 @@
 
 #include <PNEATM/utils.hpp>
 #include <vector>
+#include <array>
 #include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include <cstring>
 #include <fstream>
@@ -17,17 +22,45 @@ namespace pneatm {
  * It keeps track of the innovation IDs assigned to different nodes based on input and output types,
  * activation functions index and the node's repetition. It also provides a method to retrieve a unique
  * innovation ID.
+ *
+ * As for `innovationConn`, `getInnovId` can be called from several threads at once: the registry is split into shards guarded by their
+ * own mutex and the IDs are taken from an atomic counter, `renumber` making them independent of the order they have been asked in.
  */
 typedef struct innovationNode {
     /**
-     * @brief 4D map that represent the node's innovation ids in the (*input type index*, *output type index*, *activation function index*, *repetition level*) space.
+     * @brief The number of shards: two lookups falling in different shards never wait for each other.
+     */
+    static constexpr unsigned int N_SHARDS = 16;
+
+    /**
+     * @brief A part of the registry, guarded by its own mutex.
      */
-    std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, unsigned int>>>> nodeIds;
+    typedef struct shard {
+        /**
+         * @brief The mutex guarding the shard.
+         */
+        std::mutex mutex;
+
+        /**
+         * @brief 4D map that represent the node's innovation ids in the (*input type index*, *output type index*, *activation function index*, *repetition level*) space.
+         */
+        std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, unsigned int>>>> nodeIds;
+
+        /**
+         * @brief The nodes added since the last renumbering, as (*input type index*, *output type index*, *activation function index*, *repetition level*).
+         */
+        std::vector<std::array<unsigned int, 4>> added;
+    } shard_t;
+
+    /**
+     * @brief The shards of the registry, a node being stored in the shard `Shard (index_T_in, index_T_out, index_activation_fn, repetition)`.
+     */
+    std::array<shard_t, N_SHARDS> shards;
 
     /**
      * @brief The next innovation id to give
      */
-    unsigned int N_nodeId; 
+    std::atomic<unsigned int> N_nodeId;
 
     /**
      * @brief Constructor of innovationNode
@@ -38,7 +71,7 @@ typedef struct innovationNode {
     {};
 
     /**
-     * @brief Get the innovation ID for a node.
+     * @brief Get the innovation ID for a node. It is thread-safe.
      * @param index_T_in The input type index.
      * @param index_T_out The output type index.
      * @param index_activation_fn The activation function index.
@@ -46,12 +79,59 @@ typedef struct innovationNode {
      * @return The innovation ID for the specified node.
      */
     unsigned int getInnovId (unsigned int index_T_in, unsigned int index_T_out, unsigned int index_activation_fn, unsigned int repetition) {
-        if (nodeIds [index_T_in][index_T_out][index_activation_fn].find (repetition) == nodeIds [index_T_in][index_T_out][index_activation_fn].end ()) {
+        shard_t& shard = shards [Shard (index_T_in, index_T_out, index_activation_fn, repetition)];
+        std::lock_guard<std::mutex> lock (shard.mutex);
+        std::unordered_map<unsigned int, unsigned int>& ids = shard.nodeIds [index_T_in][index_T_out][index_activation_fn];
+        std::unordered_map<unsigned int, unsigned int>::iterator it = ids.find (repetition);
+        if (it == ids.end ()) {
             // the node isn't existing yet
-            nodeIds [index_T_in][index_T_out][index_activation_fn][repetition] = N_nodeId;
-            N_nodeId ++;
+            it = ids.emplace (repetition, N_nodeId.fetch_add (1)).first;
+            shard.added.push_back ({index_T_in, index_T_out, index_activation_fn, repetition});
         }
-        return nodeIds [index_T_in][index_T_out][index_activation_fn][repetition];
+        return it->second;
+    }
+
+    /**
+     * @brief Renumber the innovation IDs given from `firstId`, so that they do not depend on the order they have been asked in. It is not thread-safe.
+     * @param firstId The first ID to renumber.
+     * @param order The IDs from `firstId` in their new order; the ones missing are put after, sorted by node.
+     * @return The new IDs, `remap [id - firstId]` being the one of `id`.
+     */
+    std::vector<unsigned int> renumber (unsigned int firstId, const std::vector<unsigned int>& order) {
+        typedef struct entry {
+            std::array<unsigned int, 4> key;
+            unsigned int* id;
+        } entry_t;
+
+        // the keys are not changed: the entries are renumbered in place
+        std::vector<entry_t> entries;
+        for (shard_t& shard : shards) {
+            for (const std::array<unsigned int, 4>& key : shard.added) {
+                unsigned int& id = shard.nodeIds [key [0]][key [1]][key [2]][key [3]];
+                if (id >= firstId) {
+                    entries.push_back ({key, &id});
+                }
+            }
+            shard.added.clear ();
+        }
+
+        std::vector<unsigned int> remap (N_nodeId - firstId, UINT_MAX);
+        unsigned int nextId = firstId;
+        for (unsigned int id : order) {
+            if (remap [id - firstId] == UINT_MAX) {
+                remap [id - firstId] = nextId ++;
+            }
+        }
+        std::sort (entries.begin (), entries.end (), [] (const entry_t& entry1, const entry_t& entry2) {
+            return entry1.key < entry2.key;
+        });
+        for (entry_t& entry : entries) {
+            if (remap [*entry.id - firstId] == UINT_MAX) {
+                remap [*entry.id - firstId] = nextId ++;
+            }
+            *entry.id = remap [*entry.id - firstId];
+        }
+        return remap;
     }
 
     /**
@@ -67,8 +147,19 @@ typedef struct innovationNode {
      * @param outFile The output file stream to which the innovationNode instance will be written.
      */
     void serialize (std::ofstream& outFile) const {
+        // the shards are merged, so that the file does not depend on the sharding
+        std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, unsigned int>>>> nodeIds;
+        for (const shard_t& shard : shards) {
+            for (const auto& T_in : shard.nodeIds) {
+                for (const auto& T_out : T_in.second) {
+                    for (const auto& fn : T_out.second) {
+                        nodeIds [T_in.first][T_out.first][fn.first].insert (fn.second.begin (), fn.second.end ());
+                    }
+                }
+            }
+        }
         Serialize (nodeIds, outFile);
-        Serialize (N_nodeId, outFile);
+        Serialize (N_nodeId.load (), outFile);
     }
 
     /**
@@ -76,8 +167,36 @@ typedef struct innovationNode {
      * @param inFile The input file stream from which the innovationNode instance will be read.
      */
     void deserialize (std::ifstream& inFile) {
+        std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::unordered_map<unsigned int, unsigned int>>>> nodeIds;
         Deserialize (nodeIds, inFile);
-        Deserialize (N_nodeId, inFile);
+        for (shard_t& shard : shards) {
+            shard.nodeIds.clear ();
+            shard.added.clear ();
+        }
+        for (const auto& T_in : nodeIds) {
+            for (const auto& T_out : T_in.second) {
+                for (const auto& fn : T_out.second) {
+                    for (const std::pair<const unsigned int, unsigned int>& repetition : fn.second) {
+                        shards [Shard (T_in.first, T_out.first, fn.first, repetition.first)].nodeIds [T_in.first][T_out.first][fn.first][repetition.first] = repetition.second;
+                    }
+                }
+            }
+        }
+        unsigned int nextId;
+        Deserialize (nextId, inFile);
+        N_nodeId = nextId;
+    }
+
+    /**
+     * @brief Get the shard storing a node.
+     * @param index_T_in The input type index.
+     * @param index_T_out The output type index.
+     * @param index_activation_fn The activation function index.
+     * @param repetition The occurence of the node.
+     * @return The index of the shard.
+     */
+    static unsigned int Shard (unsigned int index_T_in, unsigned int index_T_out, unsigned int index_activation_fn, unsigned int repetition) {
+        return ((index_T_in * 73856093u) ^ (index_T_out * 19349663u) ^ (index_activation_fn * 83492791u) ^ (repetition * 2654435761u)) % N_SHARDS;
     }
 
 } innovationNode_t;
@@ -7,6 +7,7 @@
 #include <PNEATM/circular_buffer.hpp>
 #include <PNEATM/utils.hpp>
 #include <functional>
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <memory>
@@ -58,6 +59,12 @@ class Node : public NodeBase {
 		 */
 		void loadInput (void* value) override;
 
+		/**
+		 * @brief Get the current input value of the node.
+		 * @return A pointer to the input value.
+		 */
+		void* getInput () override;
+
 		/**
 		 * @brief Add a value to the node's input with a scalar factor.
 		 * @param value A pointer to the value to be added to the input.
@@ -96,7 +103,82 @@ class Node : public NodeBase {
 		bool process () override;
 
 		/**
-		 * @brief Mutate the activation function's parameters.
+		 * @brief Setup the lanes used to run the node over a batch of samples: each lane has its own input and its own outputs' buffer.
+		 * @param nbLanes The number of lanes.
+		 */
+		void setupLanes (size_t nbLanes) override;
+
+		/**
+		 * @brief Load an input value to one lane of the node (to use for input nodes only).
+		 * @param value A pointer to the input value to be loaded.
+		 * @param lane The lane.
+		 */
+		void loadInputLane (void* value, size_t lane) override;
+
+		/**
+		 * @brief Add the outputs of another node's lanes to the node's lanes' inputs with a scalar factor.
+		 * @param node The node whose outputs are added, its output type must be the input type of this node.
+		 * @param depth The outputs's depth (e.g 0 stands for the current outputs and 3 means 3 calls ro runNetworkBatch later).
+		 * @param scalar The scalar factor to multiply the outputs with.
+		 */
+		void AddToInputLanes (NodeBase* node, unsigned int depth, double scalar) override;
+
+		/**
+		 * @brief Add the outputs of another node's lanes to the node's lanes' inputs, each lane with its own scalar factor.
+		 * @param node The node whose outputs are added, its output type must be the input type of this node.
+		 * @param depth The outputs's depth (e.g 0 stands for the current outputs and 3 means 3 calls ro runNetworkBatch later).
+		 * @param scalars The scalar factors, one per lane.
+		 * @param mask The lanes to update, one flag per lane: lanes whose flag is 0 are left untouched.
+		 */
+		void AddToInputLanes (NodeBase* node, unsigned int depth, const double* scalars, const unsigned char* mask) override;
+
+		/**
+		 * @brief Get the lanes' outputs of the node at a specific time.
+		 * @param depth The outputs's depth (e.g 0 stands for the current outputs and 3 means 3 calls ro runNetworkBatch later). (default is 0)
+		 * @return A pointer to the contiguous outputs of the lanes.
+		 */
+		void* getOutputLanes (unsigned int depth = 0) override;
+
+		/**
+		 * @brief Get the output value of one lane of the node at a specific time.
+		 * @param lane The lane.
+		 * @param depth The output's depth (e.g 0 stands for the current output and 3 means 3 calls ro runNetworkBatch later). (default is 0)
+		 * @return A pointer to the output value of the lane at the given time.
+		 */
+		void* getOutputLane (size_t lane, unsigned int depth = 0) override;
+
+		/**
+		 * @brief Reset the lanes' inputs.
+		 */
+		void resetLanes () override;
+
+		/**
+		 * @brief Process every lane of the node to compute their output value.
+		 * @return 'false' if one of the results is NaN, 'true' else.
+		 */
+		bool processLanes () override;
+
+		/**
+		 * @brief Process every lane of the node, each lane with the activation function of its own node.
+		 * @param lanesNodes The nodes whose activation function is used, one per lane: lanes whose node is `nullptr` are not processed. They must have the same types as this node.
+		 * @param nan Set to 1 for the lanes whose result is NaN, one flag per lane.
+		 */
+		void processLanes (NodeBase* const* lanesNodes, unsigned char* nan) override;
+
+		/**
+		 * @brief Save the current outputs of every lane, in the lanes' order, to the saved set.
+		 */
+		void saveOutputLanes () override;
+
+		/**
+		 * @brief Make the current state (input and outputs' buffer) of a lane the current state of the node.
+		 * @param node The node that owns the lane, it must have the same types and at least the same recurrency depth. It can be this node.
+		 * @param lane The lane.
+		 */
+		void loadLane (NodeBase* node, size_t lane) override;
+
+		/**
+		 * @brief Mutate the activation function's parameters, which are copied first as they may be shared with clones of the node.
 		 * @param fitness The current genome's fitness
 		 */
 		void mutate (double fitness) override;
@@ -110,11 +192,17 @@ class Node : public NodeBase {
 		void reset (bool resetMemory = true, bool resetBuffer = false, bool resetInput = true) override;
 
 		/**
-		 * @brief Create a clone of the node.
+		 * @brief Create a clone of the node, sharing its activation function until one of them mutates it.
 		 * @return A unique pointer to the cloned node.
 		 */
 		std::unique_ptr<NodeBase> clone () override;
 
+		/**
+		 * @brief Make another node a clone of the node, reusing its memory. Its activation function is shared as with `clone`.
+		 * @param node The node to overwrite, which must be a Node<T_in, T_out>.
+		 */
+		void cloneInto (NodeBase* node) const override;
+
 		/**
 		 * @brief Print information about the node.
 		 * @param prefix A prefix to print before each line. (default is an empty string)
@@ -138,8 +226,15 @@ class Node : public NodeBase {
 		T_in input;
 		CircularBuffer<T_out> outputs_buf;
 		std::vector<T_out> outputs_saved;
-		std::unique_ptr<ActivationFn<T_in, T_out>> activation_fn;
+		std::shared_ptr<const ActivationFn<T_in, T_out>> activation_fn;	// shared with the clones of the node, never written once shared
 		T_in resetValue;
+		std::vector<T_in> inputs_lanes;
+		CircularBuffer<std::vector<T_out>> outputs_lanes_buf;
+
+		Node (const std::shared_ptr<const ActivationFn<T_in, T_out>>& activation_fn);
+
+	template <bool Enabled, typename... Args>
+	friend class TypedNetwork;
 };
 
 }
@@ -151,19 +246,27 @@ using namespace pneatm;
 
 template <typename T_in, typename T_out>
 Node<T_in, T_out>::Node () :
-	activation_fn (std::make_unique<ActivationFn<T_in, T_out>> ())
+	activation_fn (std::make_shared<ActivationFn<T_in, T_out>> ())
 {
 	is_useful = false;
 	max_depth_recu = 0;
 }
 
 template <typename T_in, typename T_out>
-void Node<T_in, T_out>::setActivationFn (std::unique_ptr<ActivationFnBase> actfn, activationFnParams_t* parameters) {
-	activation_fn = std::unique_ptr<ActivationFn<T_in, T_out>> (static_cast<ActivationFn<T_in, T_out>*> (actfn.release ()));
+Node<T_in, T_out>::Node (const std::shared_ptr<const ActivationFn<T_in, T_out>>& activation_fn) :
+	activation_fn (activation_fn)
+{
+	is_useful = false;
+	max_depth_recu = 0;
+}
 
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::setActivationFn (std::unique_ptr<ActivationFnBase> actfn, activationFnParams_t* parameters) {
+	std::shared_ptr<ActivationFn<T_in, T_out>> activationFn (static_cast<ActivationFn<T_in, T_out>*> (actfn.release ()));
 	if (parameters != nullptr) {
-		activation_fn->setParameters (parameters);
+		activationFn->setParameters (parameters);
 	}
+	activation_fn = activationFn;
 }
 
 template <typename T_in, typename T_out>
@@ -176,6 +279,11 @@ void Node<T_in, T_out>::loadInput (void* value) {
 	input = *static_cast<T_in*> (value);
 }
 
+template <typename T_in, typename T_out>
+void* Node<T_in, T_out>::getInput () {
+	return static_cast<void*> (&input);
+}
+
 template <typename T_in, typename T_out>
 void Node<T_in, T_out>::AddToInput (void* value, double scalar) {
 	input += *static_cast<T_in*> (value) * scalar;
@@ -203,7 +311,7 @@ std::vector<void*> Node<T_in, T_out>::getSavedOutputs () {
 
 template <typename T_in, typename T_out>
 void Node<T_in, T_out>::setupOutputs () {
-	outputs_buf = CircularBuffer<T_out> (max_depth_recu + 1);
+	outputs_buf.reset (max_depth_recu + 1);
 }
 
 template <typename T_in, typename T_out>
@@ -214,9 +322,101 @@ bool Node<T_in, T_out>::process () {
 	return true;
 }
 
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::setupLanes (size_t nbLanes) {
+	inputs_lanes.assign (nbLanes, input);	// bias nodes keep their value in every lane
+	outputs_lanes_buf = CircularBuffer<std::vector<T_out>> (max_depth_recu + 1);
+	for (unsigned int depth = 0; depth <= max_depth_recu; depth++) {
+		outputs_lanes_buf.access_ptr (depth)->resize (nbLanes);
+	}
+}
+
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::loadInputLane (void* value, size_t lane) {
+	inputs_lanes [lane] = *static_cast<T_in*> (value);
+}
+
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::AddToInputLanes (NodeBase* node, unsigned int depth, double scalar) {
+	const T_in* values = static_cast<T_in*> (node->getOutputLanes (depth));
+	T_in* inputs = inputs_lanes.data ();
+	const size_t nbLanes = inputs_lanes.size ();
+	for (size_t lane = 0; lane < nbLanes; lane++) {
+		inputs [lane] = static_cast<T_in> (inputs [lane] + values [lane] * scalar);	// summed in double then converted, as runNetwork does
+	}
+}
+
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::AddToInputLanes (NodeBase* node, unsigned int depth, const double* scalars, const unsigned char* mask) {
+	const T_in* values = static_cast<T_in*> (node->getOutputLanes (depth));
+	T_in* inputs = inputs_lanes.data ();
+	const size_t nbLanes = inputs_lanes.size ();
+	for (size_t lane = 0; lane < nbLanes; lane++) {
+		if (mask [lane]) inputs [lane] = static_cast<T_in> (inputs [lane] + values [lane] * scalars [lane]);
+	}
+}
+
+template <typename T_in, typename T_out>
+void* Node<T_in, T_out>::getOutputLanes (unsigned int depth) {
+	return static_cast<void*> (outputs_lanes_buf.access_ptr (depth)->data ());
+}
+
+template <typename T_in, typename T_out>
+void* Node<T_in, T_out>::getOutputLane (size_t lane, unsigned int depth) {
+	return static_cast<void*> (&(*outputs_lanes_buf.access_ptr (depth)) [lane]);
+}
+
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::resetLanes () {
+	std::fill (inputs_lanes.begin (), inputs_lanes.end (), resetValue);
+}
+
+template <typename T_in, typename T_out>
+bool Node<T_in, T_out>::processLanes () {
+	T_out* outputs = outputs_lanes_buf.next_ptr ()->data ();
+	const size_t nbLanes = inputs_lanes.size ();
+	activation_fn->process (inputs_lanes.data (), outputs, nbLanes);
+	for (size_t lane = 0; lane < nbLanes; lane++) {
+		if (outputs [lane] != outputs [lane]) return false;
+	}
+	outputs_lanes_buf.advance ();
+	return true;
+}
+
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::processLanes (NodeBase* const* lanesNodes, unsigned char* nan) {
+	T_out* outputs = outputs_lanes_buf.next_ptr ()->data ();
+	const size_t nbLanes = inputs_lanes.size ();
+	for (size_t lane = 0; lane < nbLanes; lane++) {
+		if (lanesNodes [lane] != nullptr) {
+			outputs [lane] = static_cast<Node<T_in, T_out>*> (lanesNodes [lane])->activation_fn->process (inputs_lanes [lane]);
+			if (outputs [lane] != outputs [lane]) nan [lane] = 1;
+		}
+	}
+	outputs_lanes_buf.advance ();
+}
+
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::saveOutputLanes () {
+	const std::vector<T_out>& outputs = *outputs_lanes_buf.access_ptr (0);
+	outputs_saved.insert (outputs_saved.end (), outputs.begin (), outputs.end ());
+}
+
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::loadLane (NodeBase* node, size_t lane) {
+	Node<T_in, T_out>* owner = static_cast<Node<T_in, T_out>*> (node);
+	input = owner->inputs_lanes [lane];
+	for (unsigned int depth = max_depth_recu + 1; depth-- > 0;) {
+		outputs_buf.insert ((*owner->outputs_lanes_buf.access_ptr (depth)) [lane]);
+	}
+}
+
 template <typename T_in, typename T_out>
 void Node<T_in, T_out>::mutate (double fitness) {
-	activation_fn->mutate (fitness);
+	// the activation function is never written once shared: the mutation is made on a copy, which is then the node's own
+	std::unique_ptr<ActivationFnBase> activationFn = activation_fn->clone (true);
+	activationFn->mutate (fitness);
+	setActivationFn (std::move (activationFn));
 }
 
 template <typename T_in, typename T_out>
@@ -231,21 +431,34 @@ void Node<T_in, T_out>::reset (bool resetMemory, bool resetBuffer, bool resetInp
 
 template <typename T_in, typename T_out>
 std::unique_ptr<NodeBase> Node<T_in, T_out>::clone () {
-	std::unique_ptr<NodeBase> node =  std::make_unique<Node<T_in, T_out>> ();
-
-	node->id = id;
-	node->innovId = innovId;
-	node->layer = layer;
-	node->index_T_in = index_T_in;
-	node->index_T_out = index_T_out;
-	node->index_activation_fn = index_activation_fn;
-	node->setResetValue (static_cast<void*> (&resetValue));
-	node->setActivationFn (activation_fn->clone (true));	// note that we keep parameters as they are here
-	node->loadInput (static_cast<void*> (&input));
-
+	std::unique_ptr<NodeBase> node (new Node<T_in, T_out> (activation_fn));	// the activation function is shared rather than cloned
+	cloneInto (node.get ());
 	return node;
 }
 
+template <typename T_in, typename T_out>
+void Node<T_in, T_out>::cloneInto (NodeBase* node) const {
+	Node<T_in, T_out>* clone = static_cast<Node<T_in, T_out>*> (node);
+
+	clone->id = id;
+	clone->innovId = innovId;
+	clone->layer = layer;
+	clone->index_T_in = index_T_in;
+	clone->index_T_out = index_T_out;
+	clone->index_activation_fn = index_activation_fn;
+	clone->activation_fn = activation_fn;
+	clone->resetValue = resetValue;
+	clone->input = input;
+
+	// the rest is the state of a new node, the buffers keeping their memory
+	clone->is_useful = false;
+	clone->max_depth_recu = 0;
+	clone->outputs_buf.reset (0);
+	clone->outputs_saved.clear ();
+	clone->inputs_lanes.clear ();
+	clone->outputs_lanes_buf.reset (0);
+}
+
 template <typename T_in, typename T_out>
 void Node<T_in, T_out>::print (const std::string& prefix) const {
 	std::cout << prefix << "ID: " << id << std::endl;
@@ -289,8 +502,9 @@ void Node<T_in, T_out>::deserialize (std::ifstream& inFile, ActivationFnBase* ac
 	Deserialize (index_T_in, inFile);
 	Deserialize (index_T_out, inFile);
 	Deserialize (index_activation_fn, inFile);
-	setActivationFn (activationFn->clone (true));	// clone with parameters doesn't effect anything has we'll overwrite those parameters later
-	activation_fn->deserialize (inFile);	// overwrite parameters
+	std::unique_ptr<ActivationFnBase> activationFnClone = activationFn->clone (true);	// clone with parameters doesn't effect anything has we'll overwrite those parameters later
+	activationFnClone->deserialize (inFile);	// overwrite parameters
+	setActivationFn (std::move (activationFnClone));
 	Deserialize (input, inFile);
 	outputs_buf.deserialize (inFile);
 	Deserialize (outputs_saved, inFile);
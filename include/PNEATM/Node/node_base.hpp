@@ -39,6 +39,12 @@ class NodeBase{
 		 */
 		virtual void loadInput (void* value) = 0;
 
+		/**
+		 * @brief Get the current input value of the node.
+		 * @return A pointer to the input value.
+		 */
+		virtual void* getInput () = 0;
+
 		/**
 		 * @brief Add a value to the node's input with a scalar factor.
 		 * @param value A pointer to the value to be added to the input.
@@ -76,6 +82,81 @@ class NodeBase{
 		 */
 		virtual bool process () = 0;
 
+		/**
+		 * @brief Setup the lanes used to run the node over a batch of samples: each lane has its own input and its own outputs' buffer.
+		 * @param nbLanes The number of lanes.
+		 */
+		virtual void setupLanes (size_t nbLanes) = 0;
+
+		/**
+		 * @brief Load an input value to one lane of the node (to use for input nodes only).
+		 * @param value A pointer to the input value to be loaded.
+		 * @param lane The lane.
+		 */
+		virtual void loadInputLane (void* value, size_t lane) = 0;
+
+		/**
+		 * @brief Add the outputs of another node's lanes to the node's lanes' inputs with a scalar factor.
+		 * @param node The node whose outputs are added, its output type must be the input type of this node.
+		 * @param depth The outputs's depth (e.g 0 stands for the current outputs and 3 means 3 calls ro runNetworkBatch later).
+		 * @param scalar The scalar factor to multiply the outputs with.
+		 */
+		virtual void AddToInputLanes (NodeBase* node, unsigned int depth, double scalar) = 0;
+
+		/**
+		 * @brief Add the outputs of another node's lanes to the node's lanes' inputs, each lane with its own scalar factor.
+		 * @param node The node whose outputs are added, its output type must be the input type of this node.
+		 * @param depth The outputs's depth (e.g 0 stands for the current outputs and 3 means 3 calls ro runNetworkBatch later).
+		 * @param scalars The scalar factors, one per lane.
+		 * @param mask The lanes to update, one flag per lane: lanes whose flag is 0 are left untouched.
+		 */
+		virtual void AddToInputLanes (NodeBase* node, unsigned int depth, const double* scalars, const unsigned char* mask) = 0;
+
+		/**
+		 * @brief Get the lanes' outputs of the node at a specific time.
+		 * @param depth The outputs's depth (e.g 0 stands for the current outputs and 3 means 3 calls ro runNetworkBatch later). (default is 0)
+		 * @return A pointer to the contiguous outputs of the lanes.
+		 */
+		virtual void* getOutputLanes (unsigned int depth = 0) = 0;
+
+		/**
+		 * @brief Get the output value of one lane of the node at a specific time.
+		 * @param lane The lane.
+		 * @param depth The output's depth (e.g 0 stands for the current output and 3 means 3 calls ro runNetworkBatch later). (default is 0)
+		 * @return A pointer to the output value of the lane at the given time.
+		 */
+		virtual void* getOutputLane (size_t lane, unsigned int depth = 0) = 0;
+
+		/**
+		 * @brief Reset the lanes' inputs.
+		 */
+		virtual void resetLanes () = 0;
+
+		/**
+		 * @brief Process every lane of the node to compute their output value.
+		 * @return 'false' if one of the results is NaN, 'true' else.
+		 */
+		virtual bool processLanes () = 0;
+
+		/**
+		 * @brief Process every lane of the node, each lane with the activation function of its own node.
+		 * @param lanesNodes The nodes whose activation function is used, one per lane: lanes whose node is `nullptr` are not processed. They must have the same types as this node.
+		 * @param nan Set to 1 for the lanes whose result is NaN, one flag per lane.
+		 */
+		virtual void processLanes (NodeBase* const* lanesNodes, unsigned char* nan) = 0;
+
+		/**
+		 * @brief Save the current outputs of every lane, in the lanes' order, to the saved set.
+		 */
+		virtual void saveOutputLanes () = 0;
+
+		/**
+		 * @brief Make the current state (input and outputs' buffer) of a lane the current state of the node.
+		 * @param node The node that owns the lane, it must have the same types and at least the same recurrency depth. It can be this node.
+		 * @param lane The lane.
+		 */
+		virtual void loadLane (NodeBase* node, size_t lane) = 0;
+
 		/**
 		 * @brief Mutate the activation function's parameters.
 		 * @param fitness The current genome's fitness
@@ -96,6 +177,12 @@ class NodeBase{
 		 */
 		virtual std::unique_ptr<NodeBase> clone () = 0;
 
+		/**
+		 * @brief Make another node a clone of the node, reusing its memory.
+		 * @param node The node to overwrite, which must have the same input and output types.
+		 */
+		virtual void cloneInto (NodeBase* node) const = 0;
+
 		/**
 		 * @brief Print information about the node.
 		 * @param prefix A prefix to print before each line. (default is an empty string)
@@ -160,6 +247,10 @@ class NodeBase{
 	friend class Genome;
 	template <typename T_in, typename T_out>
 	friend class Node;
+	template <typename... Args>
+	friend class LockstepNetwork;
+	template <bool Enabled, typename... Args>
+	friend class TypedNetwork;
 };
 
 }
@@ -23,6 +23,12 @@ public:
      */
     CircularBuffer (const unsigned int capacity = 0);
 
+    /**
+     * @brief Empty the buffer and change its capacity, as a new CircularBuffer would be, while keeping the allocated memory.
+     * @param capacity The new capacity of the buffer.
+     */
+    void reset (const unsigned int capacity);
+
     /**
      * @brief Insert an element in the buffer.
      * @param elem The element to be inserted.
@@ -43,6 +49,17 @@ public:
      */
     T* access_ptr (unsigned int n);
 
+    /**
+     * @brief Get a pointer to the element that will be overwritten by the next insertion, in order to write it in place.
+     * @return T* A pointer to the next element.
+     */
+    T* next_ptr ();
+
+    /**
+     * @brief Validate the element written through `next_ptr` as the newest one.
+     */
+    void advance ();
+
     /**
      * @brief Serialize the object to an output file stream.
      * @param outFile The output file stream to which the CircularBuffer will be written.
@@ -71,6 +88,13 @@ CircularBuffer<T>::CircularBuffer (unsigned int capacity) :
     buffer.shrink_to_fit ();
 }
 
+template <typename T>
+void CircularBuffer<T>::reset (const unsigned int capacity) {
+    this->capacity = capacity;
+    buffer.assign (capacity, T ());
+    currentIndex = 0;
+}
+
 template <typename T>
 void CircularBuffer<T>::insert (const T& elem) {
     buffer [currentIndex] = elem;
@@ -87,6 +111,16 @@ T* CircularBuffer<T>::access_ptr (unsigned int n) {
     return &buffer [(currentIndex - 1 - n + capacity) % capacity];
 }
 
+template <typename T>
+T* CircularBuffer<T>::next_ptr () {
+    return &buffer [currentIndex];
+}
+
+template <typename T>
+void CircularBuffer<T>::advance () {
+    currentIndex = (currentIndex + 1) % capacity;
+}
+
 template <typename T>
 void CircularBuffer<T>::serialize (std::ofstream& outFile) const {
     Serialize (capacity, outFile);
@@ -5,17 +5,22 @@
 #include <PNEATM/Node/innovation_node.hpp>
 #include <PNEATM/Connection/connection.hpp>
 #include <PNEATM/Connection/innovation_connection.hpp>
+#include <PNEATM/Connection/gene_arrays.hpp>
+#include <PNEATM/Connection/connection_graph.hpp>
 #include <PNEATM/Node/Activation_Function/activation_function_base.hpp>
 #include <PNEATM/Node/create_node.hpp>
+#include <PNEATM/network_plan.hpp>
+#include <PNEATM/typed_network.hpp>
 #include <PNEATM/utils.hpp>
 #include <vector>
 #include <unordered_map>
-#include <set>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <cstring>
 #include <memory>
 #include <fstream>
+#include <sstream>
 #ifndef PURE_CPP
 	#include <SFML/Graphics.hpp>
 	#include <spdlog/spdlog.h>
@@ -393,6 +398,15 @@ class Genome {
 		template <typename T_in>
 		void loadInput (T_in input, int input_id);
 
+		/**
+		 * @brief Load the inputs from a contiguous array.
+		 * @tparam T_in The type of input data, which must be the type of every input.
+		 * @param inputs A pointer to the inputs to be loaded.
+		 * @param n The number of inputs, which must be the number of inputs of the network.
+		 */
+		template <typename T_in>
+		void loadInputs (const T_in* inputs, size_t n);
+
 		/**
 		 * @brief Load the inputs.
 		 * @param inputs A vector containing inputs to be loaded.
@@ -420,6 +434,30 @@ class Genome {
 		 */
 		bool runNetwork ();
 
+		/**
+		 * @brief Run the network over a batch of independent samples in one pass.
+		 * @param inputs The batch's inputs: inputs [b][i] is a pointer to the i-th input of the b-th sample.
+		 * @return 'false' if the network raised a NaN, 'true' else.
+		 *
+		 * Each sample is processed in its own lane, with its own recurrent memory: successive calls with the same batch size
+		 * carry on each lane's sequence, while calling it with another batch size restarts the lanes from a fresh memory.
+		 */
+		bool runNetworkBatch (const std::vector<std::vector<void*>>& inputs);
+
+		/**
+		 * @brief Get the outputs of the last batch run.
+		 * @tparam T_out The type of output data.
+		 * @return A contiguous block of batch size x nbOutput outputs (e.g., outputs [b * nbOutput + o] is the o-th output of the b-th sample). Return an empty vector if a NaN has been raised during the running.
+		 */
+		template <typename T_out>
+		std::vector<T_out> getOutputsBatch ();
+
+		/**
+		 * @brief Get the outputs of the last batch run.
+		 * @return A contiguous block of batch size x nbOutput void pointers to the outputs (e.g., outputs [b * nbOutput + o] is the o-th output of the b-th sample). Return an empty vector if a NaN has been raised during the running.
+		 */
+		std::vector<void*> getOutputsBatch ();
+
 		/**
 		 * @brief Save an output.
 		 */
@@ -447,6 +485,16 @@ class Genome {
 		template <typename T_out>
 		T_out getOutput (int output_id);
 
+		/**
+		 * @brief Write the outputs in a contiguous array.
+		 * @tparam T_out The type of output data, which must be the type of every output.
+		 * @param outputs A pointer to the array to fill.
+		 * @param n The size of the array, which must be the number of outputs of the network.
+		 * @return 'false' if a NaN has been raised during the running or if the size or the type does not match, 'true' else.
+		 */
+		template <typename T_out>
+		bool getOutputs (T_out* outputs, size_t n);
+
 		/**
 		 * @brief Get the saved outputs.
 		 * @return A vector of void pointer to the ouputs. Return an empty vector if a NaN has been raised during the running.
@@ -469,6 +517,10 @@ class Genome {
 
 		/**
 		 * @brief Perform mutation operations.
+		 *
+		 * The network's plan is not rebuilt after a mutation but patched at the next run: new weights are copied, new connections
+		 * and nodes are inserted at their place. It is only rebuilt if the layers have changed or if a node may have become useless.
+		 * Structural changes clear the recurrent history of the network, as a rebuild does, but weight-only changes keep it.
 		 * @param conn_innov A pointer to the connections innovation tracker.
 		 * @param node_innov A pointer to the nodes innovation tracker.
 		 * @param params Mutation parameters.
@@ -487,6 +539,22 @@ class Genome {
 		 */
 		void print (const std::string& prefix = "");
 
+		/**
+		 * @brief Export the network as a standalone C++ header, independent from PNEATM, for deployment.
+		 *
+		 * The header defines, in the namespace `name`, a `State` struct holding the recurrent history and a function
+		 * `bool run (State& state, const T* inputs_i..., T* outputs_j...)` taking one contiguous array per type of inputs and of outputs
+		 * (suffixed by the type's index, the mapping is written at the top of the header). Weights, layers and activation kernels are
+		 * unrolled as constants. A run gives exactly the outputs of runNetwork with the same inputs, including the recurrency
+		 * schedule (`N_runNetwork`); a default constructed State corresponds to resetMemory.
+		 * Only networks whose types are all arithmetic and whose useful nodes all use built-in kernels can be exported.
+		 *
+		 * @param filename The path of the header to write.
+		 * @param name The namespace of the generated code. (default is "genome")
+		 * @return True if the network has been exported, false else.
+		 */
+		bool exportCpp (const std::string& filename, const std::string& name = "genome");
+
 		/**
 		 * @brief Draw a graphical representation of the network.
 		 * @param font_path The filepath of the font to be used for labels.
@@ -509,26 +577,12 @@ class Genome {
 		void deserialize (std::ifstream& inFile);
 
 	private:
-		struct optimize_network_ope {
-			NodeBase* node_addToInput;
-			NodeBase* node_getOutput;
-			unsigned int conn_inNodeRecu;
-			double conn_weight;
-
-			optimize_network_ope (NodeBase* node_addToInput, NodeBase* node_getOutput, unsigned int conn_inNodeRecu, double conn_weight) :
-				node_addToInput (node_addToInput),
-				node_getOutput (node_getOutput),
-				conn_inNodeRecu (conn_inNodeRecu),
-				conn_weight (conn_weight)
-			{}
-
-			/**
-			 * @brief Operator< that compare optimize_network_opes relatively to their inNodeId, useful for std::set<optimize_network_ope>
-			 */
-			bool operator< (const optimize_network_ope& other) const {
-				return conn_inNodeRecu < other.conn_inNodeRecu;
-			};
-		};
+		typedef struct config {
+			std::vector<std::vector<std::vector<ActivationFnBase*>>> activationFns;
+			std::vector<ActivationFnBase*> inputsActivationFns;
+			std::vector<ActivationFnBase*> outputsActivationFns;
+			std::vector<void*> resetValues;
+		} config_t;
 
 		unsigned int id;
 		unsigned int nbBias;
@@ -536,19 +590,27 @@ class Genome {
 		unsigned int nbOutput;
 		double weightExtremumInit;
 		unsigned int N_types;
-		std::vector<std::vector<std::vector<ActivationFnBase*>>> activationFns;
-		std::vector<ActivationFnBase*> inputsActivationFns;
-		std::vector<ActivationFnBase*> outputsActivationFns;
-		std::vector<void*> resetValues;
+		std::shared_ptr<const config_t> config;	// never written: shared by the genome and its clones
+		const std::vector<std::vector<std::vector<ActivationFnBase*>>>& activationFns;
+		const std::vector<ActivationFnBase*>& inputsActivationFns;
+		const std::vector<ActivationFnBase*>& outputsActivationFns;
+		const std::vector<void*>& resetValues;
 
 		std::unordered_map <unsigned int, std::unique_ptr<NodeBase>> nodes;
+		std::vector<std::vector<std::unique_ptr<NodeBase>>> spareNodes;	// by index_T_in * N_types + index_T_out: nodes left when the genome has been overwritten, to be reused
 		std::unordered_map <unsigned int, Connection> connections;
-		std::vector<std::vector<NodeBase*>> optimize_nodes_process;	// TODO pointers or ids
-		std::vector<NodeBase*> optimize_nodes_reset;	// TODO pointers or ids
-		std::vector<std::vector<optimize_network_ope>> optimize_operations_nonrecu;	// TODO pointers or ids
-		std::set<optimize_network_ope> optimize_operations_recu_waiting;	// TODO pointers or ids
-		std::vector<optimize_network_ope> optimize_operations_recu_active;	// TODO pointers or ids
+		networkPlan_t plan;
+		TypedNetwork<allArithmetic<Types...>::value, Types...> typed;	// only built if every manipulated type is arithmetic
 		bool network_is_optimized;
+		bool network_weights_changed;	// some weights have changed since the plan has been built
+		std::vector<unsigned int> network_changed_conn;	// connections added, enabled or disabled since the plan has been built
+		geneArrays_t genes;	// the connections sorted by innovation ID, used to compare genomes
+		bool genes_changed;	// some connections have changed since the genes have been built
+		connectionGraph_t graph;	// the connections indexed by their nodes, used to check and walk the network while mutating
+		bool graph_is_built;	// the graph describes the current connections, every added connection being added to it
+		size_t N_lanes;
+		unsigned int N_runNetworkBatch;
+		double timePerWork;	// seconds per unit of work (see PlanSize) measured at the last evaluation, 0 if never measured
 
 		double fitness;
 		bool locked;
@@ -566,14 +628,27 @@ class Genome {
 		bool AddMonotypedNode (innovationConn_t* conn_innov, innovationNode_t* node_innov, unsigned int maxIterationsFindConnectionThresh);
 		bool AddBitypedNode (innovationConn_t* conn_innov, innovationNode_t* node_innov, unsigned int maxRecurrency, unsigned int maxIterationsFindNodeThresh);
 		void UpdateLayers (int nodeId);
-		void UpdateLayers_Recursive (unsigned int nodeId);
 		void OptimizeNetwork ();
-		void SetUsefulNodes_Recursive (const unsigned int nodeId);
+		void UpdateNetwork ();
+		void UpdateGenes ();
+		void InheritWeights (const geneArrays_t& otherParent);
+		void SetUsefulNodes (const unsigned int nodeId, std::vector<unsigned int>* newUseful = nullptr);
+		void InsertConnection (const Connection& conn);
+		const connectionGraph_t& Graph ();
+		bool RunLanes (const std::vector<void*>* inputs, size_t nbLanes);
+		size_t PlanSize () const;
+		Genome (const unsigned int id, unsigned int nbBias, unsigned int nbInput, unsigned int nbOutput, unsigned int N_types, const std::shared_ptr<const config_t>& config, double weightExtremumInit, spdlog::logger* logger);
+		std::unique_ptr<Genome<Types...>> Clone (std::unique_ptr<Genome<Types...>> recycled = nullptr);
+		void NewInnovations (unsigned int firstConnId, unsigned int firstNodeId, std::vector<unsigned int>& connOrder, std::vector<unsigned int>& nodeOrder) const;
+		void RenumberInnovations (unsigned int firstConnId, const std::vector<unsigned int>& connRemap, unsigned int firstNodeId, const std::vector<unsigned int>& nodeRemap);
+		bool RunSequence (const std::vector<std::vector<void*>>& inputs, bool saveOutputs);
 
 	template <typename... Types2>
 	friend class Population;
 	template <typename... Types2>
 	friend class Species;
+	template <typename... Types2>
+	friend class LockstepNetwork;
 };
 
 }
@@ -587,10 +662,11 @@ template <typename... Types>
 Genome<Types...>::Genome (const unsigned int id, const std::vector<size_t>& bias_sch, const std::vector<size_t>& inputs_sch, const std::vector<size_t>& outputs_sch, const std::vector<std::vector<size_t>>& hiddens_sch_init, const std::vector<void*>& bias_values, const std::vector<void*>& resetValues, const std::vector<std::vector<std::vector<ActivationFnBase*>>>& activationFns, const std::vector<ActivationFnBase*> inputsActivationFns, const std::vector<ActivationFnBase*> outputsActivationFns, innovationConn_t* conn_innov, innovationNode_t* node_innov, unsigned int N_ConnInit, double probRecuInit, double weightExtremumInit, unsigned int maxRecuInit, spdlog::logger* logger) :
 	id (id),
 	weightExtremumInit (weightExtremumInit),
-	activationFns (activationFns),
-	inputsActivationFns (inputsActivationFns),
-	outputsActivationFns (outputsActivationFns),
-	resetValues (resetValues),
+	config (std::make_shared<const config_t> (config_t {activationFns, inputsActivationFns, outputsActivationFns, resetValues})),
+	activationFns (config->activationFns),
+	inputsActivationFns (config->inputsActivationFns),
+	outputsActivationFns (config->outputsActivationFns),
+	resetValues (config->resetValues),
 	logger (logger)
 {
 	logger->trace ("Genome initialization");
@@ -601,6 +677,12 @@ Genome<Types...>::Genome (const unsigned int id, const std::vector<size_t>& bias
 	locked = false;
 	N_runNetwork = 0;
 	network_is_optimized = false;
+	network_weights_changed = false;
+	genes_changed = true;
+	graph_is_built = false;
+	N_lanes = 0;
+	timePerWork = 0.0;
+	N_runNetworkBatch = 0;
 
 	// NODES
 	// bias
@@ -733,7 +815,7 @@ Genome<Types...>::Genome (const unsigned int id, const std::vector<size_t>& bias
 			// weight
 			const double weight = Random_Double (- weightExtremumInit, weightExtremumInit);
 
-			connections.insert (std::make_pair (id, Connection (id, innov_id, inNodeId, outNodeId, inNodeRecu, weight, true)));
+			InsertConnection (Connection (id, innov_id, inNodeId, outNodeId, inNodeRecu, weight, true));
 
 			// update layers if needed
 			if (inNodeRecu == 0 && nodes [outNodeId]->layer <= nodes [inNodeId]->layer) {
@@ -750,10 +832,11 @@ template <typename... Types>
 Genome<Types...>::Genome (const unsigned int id, const genomeStruct_t& genome_struct, const std::vector<size_t>& bias_sch, const std::vector<size_t>& inputs_sch, const std::vector<size_t>& outputs_sch, const std::vector<void*>& bias_values, const std::vector<void*>& resetValues, const std::vector<std::vector<std::vector<ActivationFnBase*>>>& activationFns, const std::vector<ActivationFnBase*> inputsActivationFns, const std::vector<ActivationFnBase*> outputsActivationFns, innovationConn_t* conn_innov, innovationNode_t* node_innov, double weightExtremumInit, spdlog::logger* logger) :
 	id (id),
 	weightExtremumInit (weightExtremumInit),
-	activationFns (activationFns),
-	inputsActivationFns (inputsActivationFns),
-	outputsActivationFns (outputsActivationFns),
-	resetValues (resetValues),
+	config (std::make_shared<const config_t> (config_t {activationFns, inputsActivationFns, outputsActivationFns, resetValues})),
+	activationFns (config->activationFns),
+	inputsActivationFns (config->inputsActivationFns),
+	outputsActivationFns (config->outputsActivationFns),
+	resetValues (config->resetValues),
 	logger (logger)
 {
 	logger->trace ("Genome initialization");
@@ -764,6 +847,12 @@ Genome<Types...>::Genome (const unsigned int id, const genomeStruct_t& genome_st
 	locked = false;
 	N_runNetwork = 0;
 	network_is_optimized = false;
+	network_weights_changed = false;
+	genes_changed = true;
+	graph_is_built = false;
+	N_lanes = 0;
+	timePerWork = 0.0;
+	N_runNetworkBatch = 0;
 
 	// NODES
 	// bias
@@ -874,7 +963,7 @@ Genome<Types...>::Genome (const unsigned int id, const genomeStruct_t& genome_st
 		if (CheckNewConnectionValidity (conn.inNodeId, conn.outNodeId, conn.inNodeRecu)) {	// we don't care of former connections as there is no disabled connection for now
 
 			const unsigned int innov_id = conn_innov->getInnovId (nodes [conn.inNodeId]->innovId, nodes [conn.outNodeId]->innovId, conn.inNodeRecu);
-			connections.insert (std::make_pair (iConn, Connection (iConn, innov_id, conn.inNodeId, conn.outNodeId, conn.inNodeRecu, conn.weight, true)));
+			InsertConnection (Connection (iConn, innov_id, conn.inNodeId, conn.outNodeId, conn.inNodeRecu, conn.weight, true));
 
 			// update layers if needed
 			if (conn.inNodeRecu == 0 && nodes [conn.outNodeId]->layer <= nodes [conn.inNodeId]->layer) {
@@ -897,10 +986,40 @@ Genome<Types...>::Genome (const unsigned int id, unsigned int nbBias, unsigned i
 	nbOutput (nbOutput),
 	weightExtremumInit (weightExtremumInit),
 	N_types (N_types),
-	activationFns (activationFns),
-	inputsActivationFns (inputsActivationFns),
-	outputsActivationFns (outputsActivationFns),
-	resetValues (resetValues),
+	config (std::make_shared<const config_t> (config_t {activationFns, inputsActivationFns, outputsActivationFns, resetValues})),
+	activationFns (config->activationFns),
+	inputsActivationFns (config->inputsActivationFns),
+	outputsActivationFns (config->outputsActivationFns),
+	resetValues (config->resetValues),
+	logger (logger)
+{
+	logger->trace ("Genome initialization");
+	speciesId = -1;
+	fitness = 0.0;
+	locked = false;
+	N_runNetwork = 0;
+	network_is_optimized = false;
+	network_weights_changed = false;
+	genes_changed = true;
+	graph_is_built = false;
+	N_lanes = 0;
+	timePerWork = 0.0;
+	N_runNetworkBatch = 0;
+}
+
+template <typename... Types>
+Genome<Types...>::Genome (const unsigned int id, unsigned int nbBias, unsigned int nbInput, unsigned int nbOutput, unsigned int N_types, const std::shared_ptr<const config_t>& config, double weightExtremumInit, spdlog::logger* logger) :
+	id (id),
+	nbBias (nbBias),
+	nbInput (nbInput),
+	nbOutput (nbOutput),
+	weightExtremumInit (weightExtremumInit),
+	N_types (N_types),
+	config (config),
+	activationFns (config->activationFns),
+	inputsActivationFns (config->inputsActivationFns),
+	outputsActivationFns (config->outputsActivationFns),
+	resetValues (config->resetValues),
 	logger (logger)
 {
 	logger->trace ("Genome initialization");
@@ -909,18 +1028,31 @@ Genome<Types...>::Genome (const unsigned int id, unsigned int nbBias, unsigned i
 	locked = false;
 	N_runNetwork = 0;
 	network_is_optimized = false;
+	network_weights_changed = false;
+	genes_changed = true;
+	graph_is_built = false;
+	N_lanes = 0;
+	timePerWork = 0.0;
+	N_runNetworkBatch = 0;
 }
 
 template <typename... Types>
 Genome<Types...>::Genome (std::ifstream& inFile, const std::vector<void*>& resetValues, const std::vector<std::vector<std::vector<ActivationFnBase*>>>& activationFns, const std::vector<ActivationFnBase*> inputsActivationFns, const std::vector<ActivationFnBase*> outputsActivationFns, spdlog::logger* logger) :
-	activationFns (activationFns),
-	inputsActivationFns (inputsActivationFns),
-	outputsActivationFns (outputsActivationFns),
-	resetValues (resetValues),
+	config (std::make_shared<const config_t> (config_t {activationFns, inputsActivationFns, outputsActivationFns, resetValues})),
+	activationFns (config->activationFns),
+	inputsActivationFns (config->inputsActivationFns),
+	outputsActivationFns (config->outputsActivationFns),
+	resetValues (config->resetValues),
 	logger (logger)
 {
 	logger->trace ("Genome loading");
 	network_is_optimized = false;
+	network_weights_changed = false;
+	genes_changed = true;
+	graph_is_built = false;
+	N_lanes = 0;
+	timePerWork = 0.0;
+	N_runNetworkBatch = 0;
 
 	deserialize (inFile);
 }
@@ -946,7 +1078,7 @@ template <typename T_in>
 void Genome<Types...>::loadInputs (std::vector<T_in> inputs) {
 	if (!locked) {
 		for (unsigned int i = 0; i < nbInput; i++) {
-			nodes [i + nbBias]->loadInput (static_cast<void*> (&inputs [i]));
+			loadInput (static_cast<void*> (&inputs [i]), (int) i);
 		}
 	} else {
 		logger->warn ("The genome is locked, therefore you cannot load any input.");
@@ -957,17 +1089,39 @@ template <typename... Types>
 template <typename T_in>
 void Genome<Types...>::loadInput (T_in input, int input_id) {
 	if (!locked) {
-		nodes [input_id + nbBias]->loadInput (static_cast<void*> (&input));
+		loadInput (static_cast<void*> (&input), input_id);
 	} else {
 		logger->warn ("The genome is locked, therefore you cannot load any input.");
 	}
 }
 
+template <typename... Types>
+template <typename T_in>
+void Genome<Types...>::loadInputs (const T_in* inputs, size_t n) {
+	if (locked) {
+		logger->warn ("The genome is locked, therefore you cannot load any input.");
+		return;
+	}
+	if (n != nbInput) {
+		logger->warn ("The number of inputs does not match the network's one, therefore the inputs are not loaded.");
+		return;
+	}
+	if (typed.isBuilt ()) {
+		if (!typed.loadInputs (inputs, n)) {
+			logger->warn ("The inputs are not all of the same type, therefore they are not loaded.");
+		}
+	} else {
+		for (unsigned int i = 0; i < nbInput; i++) {
+			nodes [i + nbBias]->loadInput (static_cast<void*> (const_cast<T_in*> (&inputs [i])));
+		}
+	}
+}
+
 template <typename... Types>
 void Genome<Types...>::loadInputs (std::vector<void*> inputs) {
 	if (!locked) {
 		for (unsigned int i = 0; i < nbInput; i++) {
-			nodes [i + nbBias]->loadInput (inputs [i]);
+			loadInput (inputs [i], (int) i);
 		}
 	} else {
 		logger->warn ("The genome is locked, therefore you cannot load any input.");
@@ -977,7 +1131,11 @@ void Genome<Types...>::loadInputs (std::vector<void*> inputs) {
 template <typename... Types>
 void Genome<Types...>::loadInput (void* input, int input_id) {
 	if (!locked) {
-		nodes [input_id + nbBias]->loadInput (input);
+		if (typed.isBuilt ()) {
+			typed.loadInput ((unsigned int) input_id, input);
+		} else {
+			nodes [input_id + nbBias]->loadInput (input);
+		}
 	} else {
 		logger->warn ("The genome is locked, therefore you cannot load any input.");
 	}
@@ -985,12 +1143,17 @@ void Genome<Types...>::loadInput (void* input, int input_id) {
 
 template <typename... Types>
 void Genome<Types...>::resetMemory (bool resetMemory, bool resetBuffer, bool resetInput) {
+	typed.release ();	// the nodes hold the inputs again
 	N_runNetwork = 0;
 	locked = false;
 	for (std::pair<const unsigned int, std::unique_ptr<NodeBase>>& node : nodes) {
-		node.second->reset (resetMemory, resetBuffer, resetInput && node.first >= nbBias);	// bias nodes are never resetted
+		node.second->reset (resetMemory, resetBuffer && !network_is_optimized, resetInput && node.first >= nbBias);	// bias nodes are never resetted
+		if (network_is_optimized) node.second->setupOutputs ();	// the plan is kept, only the buffers are setup again
+	}
+	if (network_is_optimized) {
+		N_lanes = 0;	// lanes will have to be setup
+		typed.build (plan, nbBias, nbInput, nbOutput);
 	}
-	network_is_optimized = false;	// node's buffer will have to be setup
 }
 
 template <typename... Types>
@@ -1000,36 +1163,42 @@ bool Genome<Types...>::runNetwork () {
 		return false;
 	}
 
-	// optimize the network by sorting connections and dissociate useless nodes from useful ones
-	if (!network_is_optimized) {
-		// the function population::OptimizeNetwork has not been run
-		OptimizeNetwork ();
+	// optimize the network by sorting connections and dissociate useless nodes from useful ones, or update it after a mutation
+	UpdateNetwork ();
+
+	if (typed.isBuilt ()) {
+		// every manipulated type is arithmetic: run the plan on the typed arrays
+		if (!typed.run (N_runNetwork)) {
+			locked = true;
+			setFitness (0.0);
+			return false;
+		}
+		N_runNetwork++;
+		return true;
 	}
 
+	std::vector<NodeBase*>& slots = plan.slots;
+
 	// reset input
-	for (NodeBase* node : optimize_nodes_reset) {
-		node->reset (false, false, true);
+	for (unsigned int slot : plan.resetSlots) {
+		slots [slot]->reset (false, false, true);
 	}
 
 	// recurent connections: we already know every input, so we don't care of layers
-	typename std::set<pneatm::Genome<Types...>::optimize_network_ope>::iterator it = optimize_operations_recu_waiting.begin ();
-    while (it != optimize_operations_recu_waiting.end () && it->conn_inNodeRecu <= N_runNetwork) {
-		// it is now an active connection
-		optimize_operations_recu_active.push_back (*it);
-        it = optimize_operations_recu_waiting.erase (it);
-    }
-	for (optimize_network_ope& ope : optimize_operations_recu_active) {
-		ope.node_addToInput->AddToInput (
-			ope.node_getOutput->getOutput (ope.conn_inNodeRecu - 1),
-			ope.conn_weight
+	// the schedule gives how many of them (sorted by recurrency level) have an output to read from
+	const size_t recuEnd = plan.recuEnd (N_runNetwork);
+	for (size_t k = plan.recuBegin; k < recuEnd; k++) {
+		slots [plan.opeDst [k]]->AddToInput (
+			slots [plan.opeSrc [k]]->getOutput (plan.opeRecu [k] - 1),
+			plan.opeWeight [k]
 		);
 	}
 
-	unsigned int lastLayer = nodes [nbBias + nbInput]->layer;
-	for (unsigned int ilayer = 0; ilayer < lastLayer; ilayer++) {
+	const size_t lastLayer = plan.nbLayers () - 1;
+	for (size_t ilayer = 0; ilayer <= lastLayer; ilayer++) {
 		// process of the layer's nodes
-		for (NodeBase* node : optimize_nodes_process [ilayer]) {
-			if (!node->process ()) {
+		for (size_t k = plan.processLayerBegin [ilayer]; k < plan.processLayerBegin [ilayer + 1]; k++) {
+			if (!slots [plan.processSlots [k]]->process ()) {
 				locked = true;
 				setFitness (0.0);
 				return false;
@@ -1037,29 +1206,126 @@ bool Genome<Types...>::runNetwork () {
 		}
 
 		// non-recurrent connections: can depend on layers and so we processed them sequentially, layer per layer
-		for (optimize_network_ope& ope : optimize_operations_nonrecu [ilayer]) {
-			ope.node_addToInput->AddToInput (
-				ope.node_getOutput->getOutput (0),
-				ope.conn_weight
+		for (size_t k = plan.opeLayerBegin [ilayer]; k < plan.opeLayerBegin [ilayer + 1]; k++) {
+			slots [plan.opeDst [k]]->AddToInput (
+				slots [plan.opeSrc [k]]->getOutput (0),
+				plan.opeWeight [k]
 			);
 		}
 	}
 
-	// process outputs nodes
-	for (NodeBase* node : optimize_nodes_process.back ()) {
-		if (!node->process ()) {
-			locked = true;
-			setFitness (0.0);
-			return false;
+	N_runNetwork++;
+	return true;
+}
+
+template <typename... Types>
+bool Genome<Types...>::runNetworkBatch (const std::vector<std::vector<void*>>& inputs) {
+	if (locked) {
+		logger->warn ("The genome is locked, therefore you cannot run its network.");
+		return false;
+	}
+	if (inputs.size () == 0) {
+		logger->warn ("The batch is empty, therefore the network is not run.");
+		return false;
+	}
+	return RunLanes (inputs.data (), inputs.size ());
+}
+
+template <typename... Types>
+bool Genome<Types...>::RunLanes (const std::vector<void*>* inputs, size_t nbLanes) {
+	UpdateNetwork ();
+	std::vector<NodeBase*>& slots = plan.slots;
+
+	if (nbLanes != N_lanes) {
+		// (re)start the lanes from a fresh memory
+		for (NodeBase* node : slots) {
+			node->setupLanes (nbLanes);
 		}
+		N_lanes = nbLanes;
+		N_runNetworkBatch = 0;
 	}
 
-	N_runNetwork++;
+	// load inputs
+	for (size_t lane = 0; lane < nbLanes; lane++) {
+		for (unsigned int i = 0; i < nbInput; i++) {
+			slots [nbBias + i]->loadInputLane (inputs [lane][i], lane);
+		}
+	}
+
+	// reset input
+	for (unsigned int slot : plan.resetSlots) {
+		slots [slot]->resetLanes ();
+	}
+
+	// same plan as runNetwork, but every operation works on all the lanes at once
+	const size_t recuEnd = plan.recuEnd (N_runNetworkBatch);
+	for (size_t k = plan.recuBegin; k < recuEnd; k++) {
+		slots [plan.opeDst [k]]->AddToInputLanes (slots [plan.opeSrc [k]], plan.opeRecu [k] - 1, plan.opeWeight [k]);
+	}
+
+	const size_t lastLayer = plan.nbLayers () - 1;
+	for (size_t ilayer = 0; ilayer <= lastLayer; ilayer++) {
+		for (size_t k = plan.processLayerBegin [ilayer]; k < plan.processLayerBegin [ilayer + 1]; k++) {
+			if (!slots [plan.processSlots [k]]->processLanes ()) {
+				locked = true;
+				setFitness (0.0);
+				return false;
+			}
+		}
+
+		for (size_t k = plan.opeLayerBegin [ilayer]; k < plan.opeLayerBegin [ilayer + 1]; k++) {
+			slots [plan.opeDst [k]]->AddToInputLanes (slots [plan.opeSrc [k]], 0, plan.opeWeight [k]);
+		}
+	}
+
+	N_runNetworkBatch++;
+	return true;
+}
+
+template <typename... Types>
+bool Genome<Types...>::RunSequence (const std::vector<std::vector<void*>>& inputs, bool saveOutputs) {
+	if (locked) {
+		logger->warn ("The genome is locked, therefore you cannot run its network.");
+		return false;
+	}
+	UpdateNetwork ();
+
+	if (plan.recuBegin < plan.opeSrc.size () || inputs.size () <= 1) {
+		// each run depends on the previous ones, the sequence has to be run step by step
+		for (const std::vector<void*>& inputs_cur : inputs) {
+			loadInputs (inputs_cur);
+			if (!runNetwork ()) return false;
+			if (saveOutputs) this->saveOutputs ();
+		}
+		return true;
+	}
+
+	// without recurrent connections, the runs are independent: run the sequence as batches
+	const size_t batchSize = 256;
+	for (size_t first = 0; first < inputs.size (); first += batchSize) {
+		const size_t nbLanes = std::min (batchSize, inputs.size () - first);
+		if (!RunLanes (inputs.data () + first, nbLanes)) return false;
+		if (saveOutputs) {
+			for (unsigned int i = 0; i < nbOutput; i++) {
+				plan.slots [nbBias + nbInput + i]->saveOutputLanes ();
+			}
+		}
+		N_runNetwork += (unsigned int) nbLanes;
+	}
+
+	// leave the network as if the sequence has been run step by step
+	loadInputs (inputs.back ());
+	for (unsigned int slot : plan.processSlots) {
+		plan.slots [slot]->loadLane (plan.slots [slot], N_lanes - 1);
+	}
+	typed.nodesUpdated ();
 	return true;
 }
 
 template <typename... Types>
 void Genome<Types...>::OptimizeNetwork () {
+	typed.release ();	// the typed arrays will be rebuilt from the nodes
+
 	// check wich nodes are playing a role in the network
 	for (std::pair<const unsigned int, std::unique_ptr<NodeBase>>& node : nodes) {
 		// reset state
@@ -1071,88 +1337,411 @@ void Genome<Types...>::OptimizeNetwork () {
 		nodes [i]->is_useful = true;	// output nodes are obviously useful
 
 		// set to useful all the nodes link to this output
-		SetUsefulNodes_Recursive (i);
-	}
-
-	optimize_nodes_process.clear ();
-	optimize_nodes_reset.clear ();
-	optimize_operations_recu_waiting.clear ();
-	optimize_operations_nonrecu.clear ();
-	optimize_operations_recu_active.clear ();
-	const int lastLayer = nodes [nbBias + nbInput]->layer;
-
-	// non-recurrent connections
-	for (int ilayer = 0; ilayer <= lastLayer; ilayer++) {
-		optimize_operations_nonrecu.push_back ({});
-
-		for (const std::pair<const unsigned int, Connection>& conn : connections) {
-			if (
-				conn.second.enabled
-				&& nodes [conn.second.outNodeId]->is_useful
-				&& nodes [conn.second.inNodeId]->layer == ilayer
-				&& conn.second.inNodeRecu <= 0
-			) {	// if the connection still exist, is useful, start from the current layer and is not recurrent
-				optimize_operations_nonrecu.back ().push_back (optimize_network_ope (nodes [conn.second.outNodeId].get (), nodes [conn.second.inNodeId].get (), conn.second.inNodeRecu, conn.second.weight));
+		SetUsefulNodes (i);
+	}
+
+	const size_t nbLayers = (size_t) nodes [nbBias + nbInput]->layer + 1;
+	plan.clear ();
+
+	// slots (nodes and connections are visited by ID so that UpdateNetwork can insert new ones at the same place)
+	plan.slots.resize (nodes.size ());
+	for (unsigned int i = 0; i < (unsigned int) nodes.size (); i++) {
+		plan.slots [i] = nodes [i].get ();
+	}
+
+	// nodes to reset
+	for (unsigned int i = nbBias + nbInput; i < (unsigned int) nodes.size (); i++) {
+		if (plan.slots [i]->is_useful) {	// bias and input nodes should not be resetted
+			plan.resetSlots.push_back (i);
+		}
+	}
+
+	// nodes to process: bucket them by layer in a single pass
+	plan.processLayerBegin.assign (nbLayers + 1, 0);
+	for (NodeBase* node : plan.slots) {
+		if (node->is_useful && (size_t) node->layer < nbLayers) {
+			plan.processLayerBegin [(size_t) node->layer + 1] ++;
+		}
+	}
+	for (size_t ilayer = 0; ilayer < nbLayers; ilayer++) {
+		plan.processLayerBegin [ilayer + 1] += plan.processLayerBegin [ilayer];
+	}
+	plan.processSlots.resize (plan.processLayerBegin.back ());
+	std::vector<size_t> cursor (plan.processLayerBegin.begin (), plan.processLayerBegin.end () - 1);
+	for (unsigned int i = 0; i < (unsigned int) nodes.size (); i++) {
+		if (plan.slots [i]->is_useful && (size_t) plan.slots [i]->layer < nbLayers) {
+			plan.processSlots [cursor [(size_t) plan.slots [i]->layer] ++] = i;
+		}
+	}
+
+	// connections: non-recurrent ones are bucketed by the layer of their input node, recurrent ones are kept apart
+	std::vector<unsigned int> recurrents;
+	plan.opeLayerBegin.assign (nbLayers + 1, 0);
+	for (unsigned int connId = 0; connId < (unsigned int) connections.size (); connId++) {
+		const Connection& conn = connections [connId];
+		if (conn.enabled && plan.slots [conn.outNodeId]->is_useful) {	// if the connection still exist and is useful
+			if (conn.inNodeRecu > 0) {
+				recurrents.push_back (connId);
+
+				if (plan.slots [conn.inNodeId]->max_depth_recu < conn.inNodeRecu) {
+					plan.slots [conn.inNodeId]->max_depth_recu = conn.inNodeRecu;
+				}
+			} else {
+				plan.opeLayerBegin [(size_t) plan.slots [conn.inNodeId]->layer + 1] ++;
 			}
 		}
 	}
+	for (size_t ilayer = 0; ilayer < nbLayers; ilayer++) {
+		plan.opeLayerBegin [ilayer + 1] += plan.opeLayerBegin [ilayer];
+	}
+	std::vector<unsigned int> nonrecurrents (plan.opeLayerBegin.back ());
+	cursor.assign (plan.opeLayerBegin.begin (), plan.opeLayerBegin.end () - 1);
+	for (unsigned int connId = 0; connId < (unsigned int) connections.size (); connId++) {
+		const Connection& conn = connections [connId];
+		if (conn.enabled && plan.slots [conn.outNodeId]->is_useful && conn.inNodeRecu == 0) {
+			nonrecurrents [cursor [(size_t) plan.slots [conn.inNodeId]->layer] ++] = connId;
+		}
+	}
+	for (unsigned int connId : nonrecurrents) {
+		const Connection& conn = connections [connId];
+		plan.addOperation (conn.inNodeId, conn.outNodeId, 0, conn.weight, connId);
+	}
 
-	// recurrent connections: sort them by recurrency level from the lowest to the highest
-	for (const std::pair<const unsigned int, Connection>& conn : connections) {
-		if (
-			conn.second.enabled
-			&& nodes [conn.second.outNodeId]->is_useful
-			&& conn.second.inNodeRecu > 0
-		) {	// if the connection still exist, is useful and is recurrent
-			optimize_operations_recu_waiting.insert (optimize_network_ope (nodes [conn.second.outNodeId].get (), nodes [conn.second.inNodeId].get (), conn.second.inNodeRecu, conn.second.weight));
-
-			if (nodes [conn.second.inNodeId]->max_depth_recu < conn.second.inNodeRecu) {
-				nodes [conn.second.inNodeId]->max_depth_recu = conn.second.inNodeRecu;
+	// recurrent connections: sort them by recurrency level from the lowest to the highest and build their activation schedule
+	std::stable_sort (recurrents.begin (), recurrents.end (), [this] (unsigned int connId1, unsigned int connId2) {
+		return connections [connId1].inNodeRecu < connections [connId2].inNodeRecu;
+	});
+	plan.recuBegin = plan.opeSrc.size ();
+	for (unsigned int connId : recurrents) {
+		const Connection& conn = connections [connId];
+		plan.addOperation (conn.inNodeId, conn.outNodeId, conn.inNodeRecu, conn.weight, connId);
+	}
+	plan.schedule ();
+
+	for (NodeBase* node : plan.slots) {
+		node->setupOutputs ();
+	}
+	N_lanes = 0;	// lanes will have to be setup
+
+	typed.build (plan, nbBias, nbInput, nbOutput);
+
+	network_is_optimized = true;
+	network_weights_changed = false;
+	network_changed_conn.clear ();
+}
+
+template <typename... Types>
+void Genome<Types...>::UpdateNetwork () {
+	if (!network_is_optimized) {
+		// there is no plan to update (or the layers have changed)
+		OptimizeNetwork ();
+		return;
+	}
+
+	if (network_changed_conn.size () > 0) {
+		// the structure has changed, but not the layers: the plan is updated in place
+		typed.release ();	// the typed arrays will be rebuilt from the nodes
+
+		// slots of the new nodes
+		const unsigned int nbSlots = (unsigned int) plan.slots.size ();
+		plan.slots.resize (nodes.size ());
+		for (unsigned int i = nbSlots; i < (unsigned int) nodes.size (); i++) {
+			plan.slots [i] = nodes [i].get ();
+			plan.slots [i]->is_useful = false;
+			plan.slots [i]->max_depth_recu = 0;
+		}
+
+		std::vector<bool> inPlan (connections.size (), false);
+		for (unsigned int connId : plan.opeConn) {
+			inPlan [connId] = true;
+		}
+
+		// reachability from the outputs is only explored from the sources of the new useful connections
+		std::vector<unsigned int> newUseful;
+		for (unsigned int connId : network_changed_conn) {
+			const Connection& conn = connections [connId];
+			if (conn.enabled && plan.slots [conn.outNodeId]->is_useful && !plan.slots [conn.inNodeId]->is_useful) {
+				plan.slots [conn.inNodeId]->is_useful = true;
+				newUseful.push_back (conn.inNodeId);
+				SetUsefulNodes (conn.inNodeId, &newUseful);
+			}
+		}
+
+		// connections to add: the new useful ones and the ones going to a new useful node; connections to remove: the disabled ones
+		std::vector<bool> isNewUseful (nodes.size (), false);
+		for (unsigned int nodeId : newUseful) {
+			isNewUseful [nodeId] = true;
+		}
+		std::vector<bool> toRemove (connections.size (), false);
+		std::vector<unsigned int> toAdd;
+		for (unsigned int connId : network_changed_conn) {
+			const Connection& conn = connections [connId];
+			if (inPlan [connId] && !conn.enabled) {
+				toRemove [connId] = true;
+			} else if (!inPlan [connId] && conn.enabled && plan.slots [conn.outNodeId]->is_useful && !isNewUseful [conn.outNodeId]) {
+				inPlan [connId] = true;
+				toAdd.push_back (connId);
+			}
+		}
+		if (newUseful.size () > 0) {
+			for (unsigned int connId = 0; connId < (unsigned int) connections.size (); connId++) {
+				const Connection& conn = connections [connId];
+				if (conn.enabled && isNewUseful [conn.outNodeId]) {
+					toAdd.push_back (connId);
+				}
+			}
+		}
+
+		// a removed connection may leave its input node useless, and the nodes behind it: let's rebuild everything in that case
+		if (std::find (toRemove.begin (), toRemove.end (), true) != toRemove.end ()) {
+			const connectionGraph_t& graph = Graph ();
+			for (unsigned int connId : network_changed_conn) {
+				if (toRemove [connId]) {
+					// the input node is still useful if it still reaches an output node
+					bool stillUseful = false;
+					std::vector<bool> visited (nodes.size (), false);
+					std::vector<unsigned int> toVisit (1, connections [connId].inNodeId);
+					visited [toVisit.back ()] = true;
+					while (toVisit.size () > 0 && !stillUseful) {
+						const unsigned int nodeId = toVisit.back ();
+						toVisit.pop_back ();
+						stillUseful = nodeId >= nbBias + nbInput && nodeId < nbBias + nbInput + nbOutput;
+						for (unsigned int nextConnId : graph.outgoing (nodeId)) {
+							const Connection& next = connections [nextConnId];
+							if (next.enabled && !visited [next.outNodeId]) {
+								visited [next.outNodeId] = true;
+								toVisit.push_back (next.outNodeId);
+							}
+						}
+					}
+					if (!stillUseful) {
+						OptimizeNetwork ();
+						return;
+					}
+				}
+			}
+		}
+
+		// new nodes to process and to reset, merged at their place (by layer, then by ID)
+		const auto nodeBefore = [this] (unsigned int nodeId1, unsigned int nodeId2) {
+			return plan.slots [nodeId1]->layer != plan.slots [nodeId2]->layer ? plan.slots [nodeId1]->layer < plan.slots [nodeId2]->layer : nodeId1 < nodeId2;
+		};
+		std::vector<unsigned int> newProcessed;
+		for (unsigned int nodeId : newUseful) {
+			if ((size_t) plan.slots [nodeId]->layer < plan.nbLayers ()) {
+				newProcessed.push_back (nodeId);
 			}
+			if (nodeId >= nbBias + nbInput) {
+				plan.resetSlots.push_back (nodeId);
+			}
+		}
+		std::sort (plan.resetSlots.begin (), plan.resetSlots.end ());
+		std::sort (newProcessed.begin (), newProcessed.end (), nodeBefore);
+		std::vector<unsigned int> processSlots (plan.processSlots.size () + newProcessed.size ());
+		std::merge (plan.processSlots.begin (), plan.processSlots.end (), newProcessed.begin (), newProcessed.end (), processSlots.begin (), nodeBefore);
+		plan.processSlots.swap (processSlots);
+		std::fill (plan.processLayerBegin.begin (), plan.processLayerBegin.end (), 0);
+		for (unsigned int nodeId : plan.processSlots) {
+			plan.processLayerBegin [(size_t) plan.slots [nodeId]->layer + 1] ++;
+		}
+		for (size_t ilayer = 0; ilayer < plan.nbLayers (); ilayer++) {
+			plan.processLayerBegin [ilayer + 1] += plan.processLayerBegin [ilayer];
 		}
+
+		// operations, merged at their place (non-recurrent ones by layer of their input node, then recurrent ones by recurrency level, then by ID)
+		const auto opeBefore = [this] (unsigned int connId1, unsigned int connId2) {
+			const Connection& conn1 = connections [connId1];
+			const Connection& conn2 = connections [connId2];
+			const long long key1 = conn1.inNodeRecu > 0 ? (long long) plan.nbLayers () + conn1.inNodeRecu : (long long) plan.slots [conn1.inNodeId]->layer;
+			const long long key2 = conn2.inNodeRecu > 0 ? (long long) plan.nbLayers () + conn2.inNodeRecu : (long long) plan.slots [conn2.inNodeId]->layer;
+			return key1 != key2 ? key1 < key2 : connId1 < connId2;
+		};
+		std::sort (toAdd.begin (), toAdd.end (), opeBefore);
+		std::vector<unsigned int> opeConn;
+		opeConn.reserve (plan.opeConn.size () + toAdd.size ());
+		for (unsigned int connId : plan.opeConn) {
+			if (!toRemove [connId]) {
+				opeConn.push_back (connId);
+			}
+		}
+		std::vector<unsigned int> merged (opeConn.size () + toAdd.size ());
+		std::merge (opeConn.begin (), opeConn.end (), toAdd.begin (), toAdd.end (), merged.begin (), opeBefore);
+
+		const size_t nbLayers = plan.nbLayers ();
+		plan.opeSrc.clear ();
+		plan.opeDst.clear ();
+		plan.opeRecu.clear ();
+		plan.opeWeight.clear ();
+		plan.opeConn.clear ();
+		plan.opeLayerBegin.assign (nbLayers + 1, 0);
+		for (NodeBase* node : plan.slots) {
+			node->max_depth_recu = 0;
+		}
+		for (unsigned int connId : merged) {
+			const Connection& conn = connections [connId];
+			if (conn.inNodeRecu > 0) {
+				if (plan.slots [conn.inNodeId]->max_depth_recu < conn.inNodeRecu) {
+					plan.slots [conn.inNodeId]->max_depth_recu = conn.inNodeRecu;
+				}
+			} else {
+				plan.opeLayerBegin [(size_t) plan.slots [conn.inNodeId]->layer + 1] ++;
+			}
+			plan.addOperation (conn.inNodeId, conn.outNodeId, conn.inNodeRecu, conn.weight, connId);
+		}
+		for (size_t ilayer = 0; ilayer < nbLayers; ilayer++) {
+			plan.opeLayerBegin [ilayer + 1] += plan.opeLayerBegin [ilayer];
+		}
+		plan.recuBegin = plan.opeLayerBegin.back ();
+		plan.schedule ();
+
+		// as a rebuild would do, the recurrent history is cleared
+		for (NodeBase* node : plan.slots) {
+			node->setupOutputs ();
+		}
+		N_lanes = 0;	// lanes will have to be setup
+
+		typed.build (plan, nbBias, nbInput, nbOutput);
+
+		network_weights_changed = false;
+		network_changed_conn.clear ();
+	} else if (network_weights_changed) {
+		// only the weights have changed: they are patched
+		for (size_t k = 0; k < plan.opeConn.size (); k++) {
+			plan.opeWeight [k] = connections [plan.opeConn [k]].weight;
+		}
+		typed.patchWeights (plan);
+
+		network_weights_changed = false;
 	}
+}
 
-	// nodes
-	for (unsigned int i = nbBias + nbInput; i < (unsigned int) nodes.size (); i++) {
-		if (nodes [i]->is_useful && nodes [i]->id >= nbBias) {	// bias nodes should not be resetted
-			optimize_nodes_reset.push_back (nodes [i].get ());
+template <typename... Types>
+void Genome<Types...>::UpdateGenes () {
+	if (genes_changed) {
+		genes.build (connections);
+		genes_changed = false;
+	}
+}
+
+template <typename... Types>
+void Genome<Types...>::InheritWeights (const geneArrays_t& otherParent) {
+	// the genome is a clone of a parent: its genes and the other parent's ones are aligned by a single merge pass
+	UpdateGenes ();
+	const size_t sz = genes.size ();
+	const size_t szOther = otherParent.size ();
+	bool changed = false;
+	size_t k = 0;
+	size_t kOther = 0;
+	while (k < sz && kOther < szOther) {
+		if (genes.innovIds [k] < otherParent.innovIds [kOther]) {
+			k ++;
+		} else if (otherParent.innovIds [kOther] < genes.innovIds [k]) {
+			kOther ++;
+		} else {
+			// connections shared by both of the parents are randomly wheighted, taking the weight of the first connection of the other parent
+			const unsigned int innovId = genes.innovIds [k];
+			while (k < sz && genes.innovIds [k] == innovId) {
+				if (Random_Double (0.0, 1.0, true, false) < 0.5) {	// 50 % of chance for each parent, the genome already have the wheight of its parent
+					genes.weights [k] = otherParent.weights [kOther];
+					changed = true;
+				}
+				k ++;
+			}
+			while (kOther < szOther && otherParent.innovIds [kOther] == innovId) {
+				kOther ++;
+			}
 		}
 	}
-	for (int ilayer = 0; ilayer <= lastLayer; ilayer++) {
-		optimize_nodes_process.push_back ({});
 
-		for (std::pair<const unsigned int, std::unique_ptr<NodeBase>>& node : nodes) {
-			if (node.second->is_useful && node.second->layer == ilayer) {
-				optimize_nodes_process.back ().push_back (node.second.get ());
+	if (changed) {
+		// the weights are written back by connection's ID, in a single pass over the connections
+		std::vector<double> weights (sz);
+		for (size_t i = 0; i < sz; i++) {
+			weights [genes.connIds [i]] = genes.weights [i];
+		}
+		for (std::pair<const unsigned int, Connection>& conn : connections) {
+			conn.second.weight = weights [conn.first];
+		}
+		network_weights_changed = true;
+	}
+}
+
+template <typename... Types>
+size_t Genome<Types...>::PlanSize () const {
+	// the work of one run: an operation per connection and a process per node
+	if (network_is_optimized) return plan.opeSrc.size () + plan.processSlots.size ();
+	return connections.size () + nodes.size ();	// the plan is not built yet
+}
+
+template <typename... Types>
+void Genome<Types...>::SetUsefulNodes (const unsigned int nodeId, std::vector<unsigned int>* newUseful) {
+	// the nodes reaching a useful node through enabled connections are useful, each one being visited once
+	const connectionGraph_t& graph = Graph ();
+	thread_local std::vector<unsigned int> toVisit;
+	toVisit.assign (1, nodeId);
+	while (!toVisit.empty ()) {
+		const unsigned int outNodeId = toVisit.back ();
+		toVisit.pop_back ();
+		for (unsigned int connId : graph.incoming (outNodeId)) {
+			const Connection& conn = connections [connId];
+			if (conn.enabled && !nodes [conn.inNodeId]->is_useful) {
+				// this new node is useful but has not been processed, we processed it now
+				nodes [conn.inNodeId]->is_useful = true;
+				if (newUseful != nullptr) newUseful->push_back (conn.inNodeId);
+				toVisit.push_back (conn.inNodeId);
 			}
 		}
 	}
-	for (std::pair<const unsigned int, std::unique_ptr<NodeBase>>& node : nodes) {
-		node.second->setupOutputs ();
+}
+
+template <typename... Types>
+void Genome<Types...>::InsertConnection (const Connection& conn) {
+	connections.insert (std::make_pair (conn.id, conn));
+	if (graph_is_built) {
+		graph.add (conn);
 	}
+}
 
-	// optimize memory consumption
-	optimize_nodes_process.shrink_to_fit ();
-	optimize_nodes_reset.shrink_to_fit ();
-	optimize_operations_nonrecu.shrink_to_fit ();
-	optimize_operations_recu_active.reserve (optimize_operations_recu_waiting.size ());
+template <typename... Types>
+const connectionGraph_t& Genome<Types...>::Graph () {
+	// built when it is first needed, then kept up to date by InsertConnection
+	if (!graph_is_built) {
+		graph.build (connections, nodes.size ());
+		graph_is_built = true;
+	}
+	return graph;
+}
 
-	network_is_optimized = true;
+template <typename... Types>
+template <typename T_out>
+std::vector<T_out> Genome<Types...>::getOutputsBatch () {
+	if (locked) {
+		logger->warn ("The genome is locked, therefore you cannot get any output.");
+		return {};
+	}
+	std::vector<T_out> outputs (N_lanes * nbOutput);
+	for (unsigned int i = 0; i < nbOutput; i++) {
+		const T_out* outputs_lanes = static_cast<T_out*> (nodes [nbBias + nbInput + i]->getOutputLanes ());
+		for (size_t lane = 0; lane < N_lanes; lane++) {
+			outputs [lane * nbOutput + i] = outputs_lanes [lane];
+		}
+	}
+	return outputs;
 }
 
 template <typename... Types>
-void Genome<Types...>::SetUsefulNodes_Recursive (const unsigned int nodeId) {
-	for (const std::pair<const unsigned int, Connection>& conn : connections) {
-		if (
-			conn.second.enabled
-			&& conn.second.outNodeId == nodeId
-			&& !nodes [conn.second.inNodeId]->is_useful
-		) {
-			// this new node is useful but has not been processed, we processed it now
-			nodes [conn.second.inNodeId]->is_useful = true;
-			SetUsefulNodes_Recursive (conn.second.inNodeId);
+std::vector<void*> Genome<Types...>::getOutputsBatch () {
+	if (locked) {
+		logger->warn ("The genome is locked, therefore you cannot get any output.");
+		return {};
+	}
+	std::vector<void*> outputs (N_lanes * nbOutput);
+	for (unsigned int i = 0; i < nbOutput; i++) {
+		for (size_t lane = 0; lane < N_lanes; lane++) {
+			outputs [lane * nbOutput + i] = nodes [nbBias + nbInput + i]->getOutputLane (lane);
 		}
 	}
+	return outputs;
 }
 
 template <typename... Types>
@@ -1200,6 +1789,30 @@ T_out Genome<Types...>::getOutput (int output_id) {
 	return *static_cast<T_out*> (nodes [nbBias + nbInput + output_id]->getOutput ());
 }
 
+template <typename... Types>
+template <typename T_out>
+bool Genome<Types...>::getOutputs (T_out* outputs, size_t n) {
+	if (locked) {
+		logger->warn ("The genome is locked, therefore you cannot get any output.");
+		return false;
+	}
+	if (n != nbOutput) {
+		logger->warn ("The size of the array does not match the network's number of outputs, therefore no output is written.");
+		return false;
+	}
+	if (typed.isBuilt ()) {
+		if (!typed.getOutputs (outputs, n)) {
+			logger->warn ("The outputs are not all of the same type, therefore they are not all written.");
+			return false;
+		}
+		return true;
+	}
+	for (unsigned int i = 0; i < nbOutput; i++) {
+		outputs [i] = *static_cast<T_out*> (nodes [nbBias + nbInput + i]->getOutput ());
+	}
+	return true;
+}
+
 template <typename... Types>
 std::vector<void*> Genome<Types...>::getOutputs () {
 	if (locked) {
@@ -1278,8 +1891,8 @@ void Genome<Types...>::mutate (innovationConn_t* conn_innov, innovationNode_t* n
 			AddConnection (conn_innov, params.connections.maxRecurrency, params.connections.maxIterationsFindNode, params.connections.reactivateRate);
 		}
 
-		// reset optimizer as the network may have changed
-		network_is_optimized = false;
+		// the changes are recorded by the mutations: the network's plan will be patched (or rebuilt if the layers have changed) at the next run
+		genes_changed = true;
 
 	} else {
 		logger->warn ("The genome is locked, therefore you cannot mutate it.");
@@ -1304,18 +1917,13 @@ bool Genome<Types...>::CheckNewConnectionValidity (unsigned int inNodeId, unsign
 	if (nodes [inNodeId]->index_T_out != nodes [outNodeId]->index_T_in) return false;	// connections must link two same objects
 	if (outNodeId < nbBias + nbInput) return false;	// connections cannot point to an input node
 
-	for (const std::pair<const unsigned int, Connection>& conn : connections) {
-		if (
-			conn.second.inNodeId == inNodeId
-			&& conn.second.outNodeId == outNodeId
-			&& conn.second.inNodeRecu == inNodeRecu
-		) {
-			if (conn.second.enabled) {
-				return false;	// it is already an enabled connection
-			} else {
-				// it is a disabled connection
-				*disabled_conn_id = (int) conn.second.id;
-			}
+	const int connId = Graph ().find (inNodeId, outNodeId, inNodeRecu);
+	if (connId >= 0) {
+		if (connections [connId].enabled) {
+			return false;	// it is already an enabled connection
+		} else if (disabled_conn_id != nullptr) {
+			// it is a disabled connection
+			*disabled_conn_id = connId;
 		}
 	}
 	
@@ -1342,32 +1950,48 @@ bool Genome<Types...>::CheckNewConnectionValidity (unsigned int inNodeId, unsign
 
 template <typename... Types>
 bool Genome<Types...>::CheckNewConnectionCircle (unsigned int inNodeId, unsigned int outNodeId) {
-	if (inNodeId == outNodeId) {
-		return true;
-	}
-	for (const std::pair<const unsigned int, Connection>& conn : connections) {
-		if (conn.second.inNodeId == outNodeId && conn.second.inNodeRecu == 0) {
-			if (CheckNewConnectionCircle (inNodeId, conn.second.outNodeId)) {
-				return true;
+	// the new connection creates a circle if its input node can be reached from its output node through non-recurrent connections
+	const connectionGraph_t& graph = Graph ();
+	thread_local std::vector<bool> visited;
+	thread_local std::vector<unsigned int> toVisit;
+	visited.assign (nodes.size (), false);
+	toVisit.assign (1, outNodeId);
+	visited [outNodeId] = true;
+	while (!toVisit.empty ()) {
+		const unsigned int nodeId = toVisit.back ();
+		toVisit.pop_back ();
+		if (nodeId == inNodeId) {
+			return true;
+		}
+		for (unsigned int connId : graph.outgoing (nodeId)) {
+			const Connection& conn = connections [connId];
+			if (conn.inNodeRecu == 0 && !visited [conn.outNodeId]) {
+				visited [conn.outNodeId] = true;
+				toVisit.push_back (conn.outNodeId);
 			}
 		}
 	}
 	return false;
-
 }
 
 template <typename... Types>
 void Genome<Types...>::MutateWeights (double mutateWeightThresh, double mutateWeightFullChangeThresh, double mutateWeightFactor) {
 	logger->trace ("mutation of weights");
+	// three draws per connection, made at once: whether the weight changes, how, and its change
+	thread_local std::vector<double> draws;
+	draws.resize (3 * connections.size ());
+	Random_Doubles (draws.data (), draws.size (), 0.0, 1.0, true, false);
 	for (std::pair<const unsigned int, Connection>& conn : connections) {
-		if (conn.second.enabled && Random_Double (0.0f, 1.0f, true, false) < mutateWeightThresh) {
-			if (Random_Double (0.0f, 1.0f, true, false) < mutateWeightFullChangeThresh) {
+		const double* draw = &draws [3 * conn.first];	// by ID: the draws do not depend on the map's order
+		if (conn.second.enabled && draw [0] < mutateWeightThresh) {
+			if (draw [1] < mutateWeightFullChangeThresh) {
 				// reset weight
-				conn.second.weight = Random_Double (- weightExtremumInit, weightExtremumInit);
+				conn.second.weight = (2.0 * draw [2] - 1.0) * weightExtremumInit;
 			} else {
 				// pertub weight
-				conn.second.weight += conn.second.weight * Random_Double (- mutateWeightFactor, mutateWeightFactor);
+				conn.second.weight += conn.second.weight * (2.0 * draw [2] - 1.0) * mutateWeightFactor;
 			}
+			network_weights_changed = true;
 		}
 	}
 }
@@ -1375,12 +1999,19 @@ void Genome<Types...>::MutateWeights (double mutateWeightThresh, double mutateWe
 template <typename... Types>
 void Genome<Types...>::MutateActivationFn (double rate) {
 	logger->trace ("mutation of activation functions");
-	for (std::pair<const unsigned int, std::unique_ptr<NodeBase>>& node : nodes) {
+	// by ID: the draws do not depend on the map's order
+	bool mutated = false;
+	for (unsigned int i = nbBias + nbInput + nbOutput; i < (unsigned int) nodes.size (); i++) {
 		// we cannot mutate an input/output's activation function
-		if (node.first >= nbBias + nbInput + nbOutput && Random_Double (0.0f, 1.0f, true, false) < rate) {
-			node.second->mutate (fitness);
+		if (Random_Double (0.0f, 1.0f, true, false) < rate) {
+			nodes [i]->mutate (fitness);
+			mutated = true;
 		}
 	}
+	if (mutated) {
+		// the mutated nodes hold new activation functions
+		typed.patchActivations ();
+	}
 }
 
 template <typename... Types>
@@ -1408,6 +2039,7 @@ bool Genome<Types...>::AddConnection (innovationConn_t* conn_innov, unsigned int
 		if (disabled_conn_id >= 0) {	// it is a former connection
 			if (Random_Double (0.0f, 1.0f, true, false) < reactivateConnectionThresh) {
 				connections [disabled_conn_id].enabled = true;	// former connection is reactivated
+				network_changed_conn.push_back ((unsigned int) disabled_conn_id);
 				return true;
 			} else {
 				logger->warn ("process ended well but no connection has been added during Genome<Types...>::AddConnection");
@@ -1423,7 +2055,8 @@ bool Genome<Types...>::AddConnection (innovationConn_t* conn_innov, unsigned int
 			// weight
 			const double weight = Random_Double (- weightExtremumInit, weightExtremumInit);
 
-			connections.insert (std::make_pair (id, Connection (id, innov_id, inNodeId, outNodeId, inNodeRecu, weight, true)));
+			InsertConnection (Connection (id, innov_id, inNodeId, outNodeId, inNodeRecu, weight, true));
+			network_changed_conn.push_back (id);
 
 			// update layers
 			if (inNodeRecu == 0) {
@@ -1448,20 +2081,23 @@ bool Genome<Types...>::AddMonotypedNode (innovationConn_t* conn_innov, innovatio
 	logger->trace ("adding a node");
 	// choose at random an enabled connection
 	if (connections.size () > 0) {	// if there is no connection, we cannot add a node!
-		Connection& conn = connections [Random_UInt (0, (unsigned int) connections.size () - 1)];
+		Connection* connFound = &connections [Random_UInt (0, (unsigned int) connections.size () - 1)];
 		unsigned int iterationNb = 0;
-		while (iterationNb < maxIterationsFindConnectionThresh && !conn.enabled) {
-			conn = connections [Random_UInt (0, (unsigned int) connections.size () - 1)];
+		while (iterationNb < maxIterationsFindConnectionThresh && !connFound->enabled) {
+			connFound = &connections [Random_UInt (0, (unsigned int) connections.size () - 1)];
 			iterationNb ++;
 		}
 		if (iterationNb < maxIterationsFindConnectionThresh) {	// a connection has been found
+			Connection& conn = *connFound;
+
 			// disable former connection
 			conn.enabled = false;
+			network_changed_conn.push_back (conn.id);
 			
 			// setup new node
 			const unsigned int newNodeId = (unsigned int) nodes.size ();
-			const unsigned int iT_in = nodes [conn.inNodeId]->index_T_in;
-			const unsigned int iT_out = nodes [conn.outNodeId]->index_T_out;
+			const unsigned int iT_in = nodes [conn.inNodeId]->index_T_out;	// the connection carries the input node's output
+			const unsigned int iT_out = nodes [conn.outNodeId]->index_T_in;
 
 			// get Node<T_in, T_out>
 			nodes.insert (std::make_pair (newNodeId, CreateNode::get<Types...> (iT_in, iT_out)));
@@ -1493,7 +2129,8 @@ bool Genome<Types...>::AddMonotypedNode (innovationConn_t* conn_innov, innovatio
 			unsigned int innovId = conn_innov->getInnovId (nodes [inNodeId]->innovId, nodes [outNodeId]->innovId, inNodeRecu);
 			double weight = conn.weight;
 
-			connections.insert (std::make_pair (id, Connection (id, innovId, inNodeId, outNodeId, inNodeRecu, weight, true)));
+			InsertConnection (Connection (id, innovId, inNodeId, outNodeId, inNodeRecu, weight, true));
+			network_changed_conn.push_back (id);
 			
 			// build second connection
 			id++;
@@ -1503,7 +2140,8 @@ bool Genome<Types...>::AddMonotypedNode (innovationConn_t* conn_innov, innovatio
 			innovId = conn_innov->getInnovId (nodes [inNodeId]->innovId, nodes [outNodeId]->innovId, inNodeRecu);
 			weight = Random_Double (- weightExtremumInit, weightExtremumInit);
 
-			connections.insert (std::make_pair (id, Connection (id, innovId, inNodeId, outNodeId, inNodeRecu, weight, true)));
+			InsertConnection (Connection (id, innovId, inNodeId, outNodeId, inNodeRecu, weight, true));
+			network_changed_conn.push_back (id);
 
 			// update layers
 			if (conn.inNodeRecu > 0) {	// the connection was recurrent, so the layers are not changed
@@ -1594,7 +2232,8 @@ bool Genome<Types...>::AddBitypedNode (innovationConn_t* conn_innov, innovationN
 		unsigned int innov_id = conn_innov->getInnovId (nodes [inNodeId]->innovId, nodes [newNodeId]->innovId, inNodeRecu);
 		double weight = Random_Double (- weightExtremumInit, weightExtremumInit);
 
-		connections.insert (std::make_pair (id, Connection (id, innov_id, inNodeId, newNodeId, inNodeRecu, weight, true)));
+		InsertConnection (Connection (id, innov_id, inNodeId, newNodeId, inNodeRecu, weight, true));
+		network_changed_conn.push_back (id);
 
 		// update newNode's layer
 		if (inNodeRecu > 0) {
@@ -1623,7 +2262,8 @@ bool Genome<Types...>::AddBitypedNode (innovationConn_t* conn_innov, innovationN
 		innov_id = conn_innov->getInnovId (nodes [newNodeId]->innovId, nodes [outNodeId]->innovId, inNodeRecu);
 		weight = Random_Double (- weightExtremumInit, weightExtremumInit);
 
-		connections.insert (std::make_pair (id, Connection (id, innov_id, newNodeId, outNodeId, inNodeRecu, weight, true)));
+		InsertConnection (Connection (id, innov_id, newNodeId, outNodeId, inNodeRecu, weight, true));
+		network_changed_conn.push_back (id);
 
 		// update layers
 		if (nodes [newNodeId]->layer >= nodes [outNodeId]->layer) {
@@ -1639,28 +2279,24 @@ bool Genome<Types...>::AddBitypedNode (innovationConn_t* conn_innov, innovationN
 }
 
 template <typename... Types>
-void Genome<Types...>::UpdateLayers_Recursive (unsigned int nodeId) {
-	for (const std::pair<const unsigned int, Connection>& conn : connections) {
-		if (
-			conn.second.inNodeRecu <= 0
-			&& conn.second.enabled
-			&& conn.second.inNodeId == nodeId
-		) {
-			unsigned int newNodeId = conn.second.outNodeId;
-
-			if (nodes [newNodeId]->layer <= nodes [nodeId]->layer) {
-				nodes [newNodeId]->layer = nodes [nodeId]->layer + 1;
-
-				UpdateLayers_Recursive (newNodeId);
+void Genome<Types...>::UpdateLayers (int nodeId) {
+	network_is_optimized = false;	// the layers are about to change, the network's plan will have to be rebuilt
+
+	// Update layers: each node must be after the ones connected to it without recurrency, which never make a circle
+	const connectionGraph_t& graph = Graph ();
+	thread_local std::vector<unsigned int> toVisit;
+	toVisit.assign (1, (unsigned int) nodeId);
+	while (!toVisit.empty ()) {
+		const unsigned int inNodeId = toVisit.back ();
+		toVisit.pop_back ();
+		for (unsigned int connId : graph.outgoing (inNodeId)) {
+			const Connection& conn = connections [connId];
+			if (conn.inNodeRecu == 0 && conn.enabled && nodes [conn.outNodeId]->layer <= nodes [inNodeId]->layer) {
+				nodes [conn.outNodeId]->layer = nodes [inNodeId]->layer + 1;
+				toVisit.push_back (conn.outNodeId);
 			}
 		}
 	}
-}
-
-template <typename... Types>
-void Genome<Types...>::UpdateLayers (int nodeId) {
-	// Update layers
-	UpdateLayers_Recursive (nodeId);
 
 	// this might move some output's node, let's homogenize that
 	int outputLayer = nodes [nbBias + nbInput]->layer;
@@ -1684,22 +2320,123 @@ void Genome<Types...>::UpdateLayers (int nodeId) {
 
 template <typename... Types>
 std::unique_ptr<Genome<Types...>> Genome<Types...>::clone () {
-	std::unique_ptr<Genome<Types...>> genome =  std::make_unique<Genome<Types...>> (id, nbBias, nbInput, nbOutput, N_types, resetValues, activationFns, inputsActivationFns, outputsActivationFns, weightExtremumInit, logger);
+	typed.storeInputs ();
+	return Clone ();
+}
 
+template <typename... Types>
+std::unique_ptr<Genome<Types...>> Genome<Types...>::Clone (std::unique_ptr<Genome<Types...>> recycled) {
+	// only reads the genome, whose inputs must have been stored: a genome can be cloned by several threads at once
+	// the configuration and the nodes' activation functions are shared with the clone rather than copied
+	std::unique_ptr<Genome<Types...>> genome = std::move (recycled);
+	if (genome == nullptr) {
+		genome = std::unique_ptr<Genome<Types...>> (new Genome<Types...> (id, nbBias, nbInput, nbOutput, N_types, config, weightExtremumInit, logger));
+	} else {
+		// a genome of the same population is overwritten: it is given the state of a new genome, its containers keeping their memory
+		genome->typed.release ();
+		genome->id = id;
+		genome->speciesId = -1;
+		genome->fitness = 0.0;
+		genome->locked = false;
+		genome->N_runNetwork = 0;
+		genome->network_is_optimized = false;
+		genome->network_weights_changed = false;
+		genome->network_changed_conn.clear ();
+		genome->plan.clear ();
+		genome->genes_changed = true;
+		genome->graph_is_built = false;
+		genome->N_lanes = 0;
+		genome->timePerWork = 0.0;
+		genome->N_runNetworkBatch = 0;
+	}
+
+	// the nodes are copied into the recycled ones of the same types, the others being set aside to be reused for nodes of their types
+	genome->spareNodes.resize (N_types * N_types);
+	for (typename std::unordered_map<unsigned int, std::unique_ptr<NodeBase>>::iterator it = genome->nodes.begin (); it != genome->nodes.end ();) {
+		typename std::unordered_map<unsigned int, std::unique_ptr<NodeBase>>::const_iterator node = nodes.find (it->first);
+		if (node == nodes.end () || node->second->index_T_in != it->second->index_T_in || node->second->index_T_out != it->second->index_T_out) {
+			genome->spareNodes [it->second->index_T_in * N_types + it->second->index_T_out].push_back (std::move (it->second));
+		}
+		if (node == nodes.end ()) {
+			it = genome->nodes.erase (it);
+		} else {
+			it ++;
+		}
+	}
 	genome->nodes.reserve (nodes.size ());
 	for (const std::pair<const unsigned int, std::unique_ptr<NodeBase>>& node : nodes) {
-		genome->nodes.insert (std::make_pair (node.second->id, node.second->clone ()));
+		std::unique_ptr<NodeBase>& target = genome->nodes [node.first];
+		if (target == nullptr) {
+			std::vector<std::unique_ptr<NodeBase>>& spare = genome->spareNodes [node.second->index_T_in * N_types + node.second->index_T_out];
+			if (spare.empty ()) {
+				target = node.second->clone ();
+				continue;
+			}
+			target = std::move (spare.back ());
+			spare.pop_back ();
+		}
+		node.second->cloneInto (target.get ());
 	}
 	genome->connections.reserve (connections.size ());
 	genome->connections = connections;
 	genome->speciesId = speciesId;
 	genome->fitness = fitness;
+	genome->timePerWork = timePerWork;
+	genome->genes = genes;
+	genome->genes_changed = genes_changed;
+
+	if (network_is_optimized) {
+		// the plan is copied rather than rebuilt, its slots pointing to the new nodes
+		genome->plan = plan;
+		for (unsigned int i = 0; i < (unsigned int) plan.slots.size (); i++) {
+			NodeBase* node = genome->nodes [i].get ();
+			node->is_useful = plan.slots [i]->is_useful;
+			node->max_depth_recu = plan.slots [i]->max_depth_recu;
+			node->setupOutputs ();
+			genome->plan.slots [i] = node;
+		}
+		genome->typed.build (genome->plan, nbBias, nbInput, nbOutput);
+		genome->network_is_optimized = true;
+		genome->network_weights_changed = network_weights_changed;
+		genome->network_changed_conn = network_changed_conn;
+	}
 
 	return genome;
 }
 
+template <typename... Types>
+void Genome<Types...>::NewInnovations (unsigned int firstConnId, unsigned int firstNodeId, std::vector<unsigned int>& connOrder, std::vector<unsigned int>& nodeOrder) const {
+	// by ID, which is the order the nodes and the connections have been added in
+	for (unsigned int i = 0; i < (unsigned int) nodes.size (); i++) {
+		if (nodes.at (i)->innovId >= firstNodeId) {
+			nodeOrder.push_back (nodes.at (i)->innovId);
+		}
+	}
+	for (unsigned int i = 0; i < (unsigned int) connections.size (); i++) {
+		if (connections.at (i).innovId >= firstConnId) {
+			connOrder.push_back (connections.at (i).innovId);
+		}
+	}
+}
+
+template <typename... Types>
+void Genome<Types...>::RenumberInnovations (unsigned int firstConnId, const std::vector<unsigned int>& connRemap, unsigned int firstNodeId, const std::vector<unsigned int>& nodeRemap) {
+	for (const std::pair<const unsigned int, std::unique_ptr<NodeBase>>& node : nodes) {
+		if (node.second->innovId >= firstNodeId) {
+			node.second->innovId = nodeRemap [node.second->innovId - firstNodeId];
+		}
+	}
+	for (std::pair<const unsigned int, Connection>& conn : connections) {
+		if (conn.second.innovId >= firstConnId) {
+			conn.second.innovId = connRemap [conn.second.innovId - firstConnId];
+			genes_changed = true;
+		}
+	}
+}
+
 template <typename... Types>
 void Genome<Types...>::print (const std::string& prefix) {
+	typed.storeInputs ();
 	std::cout << prefix << "ID: " << id << std::endl;
 	std::cout << prefix << "Number of Bias Node: " << nbBias << std::endl;
 	std::cout << prefix << "Number of Input Node: " << nbInput << std::endl;
@@ -1727,6 +2464,30 @@ void Genome<Types...>::print (const std::string& prefix) {
 	}
 }
 
+template <typename... Types>
+bool Genome<Types...>::exportCpp (const std::string& filename, const std::string& name) {
+	UpdateNetwork ();
+	if (!typed.isBuilt ()) {
+		logger->warn ("Only networks whose types are all arithmetic can be exported, therefore the network is not exported.");
+		return false;
+	}
+
+	std::ostringstream code;
+	if (!typed.exportCpp (code, name)) {
+		logger->warn ("A useful node does not use a built-in activation kernel, therefore the network is not exported.");
+		return false;
+	}
+
+	std::ofstream outFile (filename);
+	if (!outFile) {
+		logger->error ("Cannot open file {} for writing.", filename);
+		return false;
+	}
+	outFile << code.str ();
+	outFile.close ();
+	return true;
+}
+
 template <typename... Types>
 void Genome<Types...>::draw (const std::string& font_path, unsigned int windowWidth, unsigned int windowHeight, float dotsRadius) {
 #ifndef PURE_CPP
@@ -1898,6 +2659,7 @@ void Genome<Types...>::draw (const std::string& font_path, unsigned int windowWi
 
 template <typename... Types>
 void Genome<Types...>::serialize (std::ofstream& outFile) {
+	typed.storeInputs ();
 	Serialize (id, outFile);
 	Serialize (nbBias, outFile);
 	Serialize (nbInput, outFile);
@@ -1953,6 +2715,10 @@ void Genome<Types...>:: deserialize (std::ifstream& inFile) {
 
 	size_t sz;
 
+	// the plan and the typed arrays point to the nodes to be replaced
+	typed.release ();
+	network_is_optimized = false;
+
 	Deserialize (sz, inFile);
 	nodes.clear ();
 	nodes.reserve (sz);
@@ -1979,6 +2745,8 @@ void Genome<Types...>:: deserialize (std::ifstream& inFile) {
 	for (unsigned int k = 0; k < (unsigned int) sz; k++) {
 		connections.insert (std::make_pair (k, Connection (inFile)));
 	}
+	genes_changed = true;
+	graph_is_built = false;
 
 	Deserialize (fitness, inFile);
 	Deserialize (locked, inFile);
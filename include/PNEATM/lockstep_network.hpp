@@ -0,0 +1,474 @@
+#ifndef LOCKSTEP_NETWORK_HPP
+#define LOCKSTEP_NETWORK_HPP
+
+#include <PNEATM/genome.hpp>
+#include <PNEATM/network_plan.hpp>
+#include <PNEATM/Node/node_base.hpp>
+#include <PNEATM/Node/create_node.hpp>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <algorithm>
+
+
+/* HEADER */
+
+namespace pneatm {
+
+/**
+ * @brief A template class that runs several genomes in lockstep over their union topology.
+ *
+ * The members's networks are merged into a single network whose nodes are keyed by their innovation id (by their id for
+ * the bias, input and output nodes) and whose connections are keyed by their nodes and recurrency. Each member is one lane
+ * of every node: operations carry one weight and one mask per lane, so that a member lacking a gene does not contribute to it,
+ * and a whole time step of the group is done in a single pass over the union plan.
+ * Genomes that cannot be merged (their layering is inconsistent with the other members's ones, they are locked or their
+ * network has already been run) are left apart and have to be run on their own.
+ * @tparam Types Variadic template arguments that contains all the manipulated types.
+ */
+template <typename... Types>
+class LockstepNetwork {
+	public:
+		/**
+		 * @brief Constructor for the LockstepNetwork class.
+		 * @param genomes The genomes to merge. They must not be modified as long as the network is used.
+		 */
+		LockstepNetwork (const std::vector<Genome<Types...>*>& genomes);
+
+		/**
+		 * @brief Get the merged genomes, the i-th one being the i-th lane.
+		 * @return The indexes, in the constructor's vector, of the merged genomes.
+		 */
+		const std::vector<size_t>& getMembers () {return membersIndex;};
+
+		/**
+		 * @brief Get the genomes that have not been merged and have to be run on their own.
+		 * @return The indexes, in the constructor's vector, of the genomes left apart.
+		 */
+		const std::vector<size_t>& getFallbacks () {return fallbacksIndex;};
+
+		/**
+		 * @brief Run the members's networks over sequences of inputs, leaving each member as if it had been run step by step with `Genome::runNetwork`.
+		 * @param inputs The members's sequences of inputs, e.g. (*inputs [lane]) [time][input_id]. All the sequences must have the same length.
+		 * @param saveOutputs Set to true to save the outputs of each step in the members.
+		 *
+		 * A member that raises a NaN is locked as `Genome::runNetwork` would do, the other members are not affected.
+		 */
+		void run (const std::vector<const std::vector<std::vector<void*>>*>& inputs, bool saveOutputs);
+
+	private:
+		std::vector<Genome<Types...>*> members;
+		std::vector<size_t> membersIndex;
+		std::vector<size_t> fallbacksIndex;
+		unsigned int nbBias;
+		unsigned int nbInput;
+		unsigned int nbOutput;
+
+		// union topology, filled member after member
+		std::unordered_map<unsigned int, unsigned int> nodesIndex;
+		std::vector<unsigned int> nodesT_in;
+		std::vector<unsigned int> nodesT_out;
+		std::map<std::tuple<unsigned int, unsigned int, unsigned int>, unsigned int> opesIndex;
+		std::vector<unsigned int> opesSrc;
+		std::vector<unsigned int> opesDst;
+		std::vector<unsigned int> opesRecu;
+		std::vector<std::vector<std::pair<unsigned int, unsigned int>>> membersNodes;	// (union node, member's slot)
+		std::vector<std::vector<std::pair<unsigned int, double>>> membersOpes;	// (union operation, weight)
+
+		// compiled union network
+		std::vector<std::unique_ptr<NodeBase>> nodes;
+		networkPlan_t plan;	// operations's weights are per lane, the plan's ones are unused
+		std::vector<NodeBase*> lanesNodes;	// lanesNodes [node * nbLanes + lane] is the member's node or nullptr if the member lacks it
+		std::vector<double> opesWeights;	// opesWeights [operation * nbLanes + lane]
+		std::vector<unsigned char> opesMasks;	// opesMasks [operation * nbLanes + lane]
+		std::vector<unsigned char> nan;
+		unsigned int N_run;
+
+		bool Merge (Genome<Types...>* genome);
+		bool TopologicalOrder (std::vector<unsigned int>* order);
+		void Build ();
+};
+
+}
+
+
+/* IMPLEMENTATIONS */
+
+using namespace pneatm;
+
+template <typename... Types>
+LockstepNetwork<Types...>::LockstepNetwork (const std::vector<Genome<Types...>*>& genomes) :
+	nbBias (0),
+	nbInput (0),
+	nbOutput (0),
+	N_run (0)
+{
+	for (size_t i = 0; i < genomes.size (); i++) {
+		if (!genomes [i]->locked && genomes [i]->N_runNetwork == 0 && Merge (genomes [i])) {
+			members.push_back (genomes [i]);
+			membersIndex.push_back (i);
+		} else {
+			fallbacksIndex.push_back (i);
+		}
+	}
+
+	if (members.size () < 2) {
+		// there is nothing to gain with a single lane
+		members.clear ();
+		membersIndex.clear ();
+		fallbacksIndex.clear ();
+		for (size_t i = 0; i < genomes.size (); i++) {
+			fallbacksIndex.push_back (i);
+		}
+		return;
+	}
+
+	Build ();
+}
+
+template <typename... Types>
+bool LockstepNetwork<Types...>::Merge (Genome<Types...>* genome) {
+	genome->UpdateNetwork ();
+	const networkPlan_t& genomePlan = genome->plan;
+
+	if (nodesT_in.size () == 0) {
+		// the first member gives the bias, input and output nodes
+		nbBias = genome->nbBias;
+		nbInput = genome->nbInput;
+		nbOutput = genome->nbOutput;
+		for (unsigned int id = 0; id < nbBias + nbInput + nbOutput; id++) {
+			nodesIndex.insert (std::make_pair (id, id));
+			nodesT_in.push_back (genomePlan.slots [id]->index_T_in);
+			nodesT_out.push_back (genomePlan.slots [id]->index_T_out);
+		}
+	} else if (genome->nbBias != nbBias || genome->nbInput != nbInput || genome->nbOutput != nbOutput) {
+		return false;
+	}
+	const unsigned int nbIO = nbBias + nbInput + nbOutput;
+
+	const size_t nbNodesBefore = nodesT_in.size ();
+	const size_t nbOpesBefore = opesSrc.size ();
+	std::vector<unsigned int> newNodesKeys;
+	std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> newOpesKeys;
+	std::vector<std::pair<unsigned int, unsigned int>> genomeNodes;
+	std::vector<std::pair<unsigned int, double>> genomeOpes;
+	std::vector<unsigned int> slotsIndex (genomePlan.slots.size (), (unsigned int) -1);
+	std::vector<bool> used;
+
+	bool valid = true;
+
+	// nodes: every useful node is processed
+	for (unsigned int slot : genomePlan.processSlots) {
+		const NodeBase* node = genomePlan.slots [slot];
+		const unsigned int key = slot < nbIO ? slot : nbIO - 1 + node->innovId;	// hidden nodes's innovation ids start from 1
+
+		std::unordered_map<unsigned int, unsigned int>::iterator it = nodesIndex.find (key);
+		unsigned int index;
+		if (it == nodesIndex.end ()) {
+			index = (unsigned int) nodesT_in.size ();
+			nodesIndex.insert (std::make_pair (key, index));
+			nodesT_in.push_back (node->index_T_in);
+			nodesT_out.push_back (node->index_T_out);
+			newNodesKeys.push_back (key);
+		} else {
+			index = it->second;
+			if (nodesT_in [index] != node->index_T_in || nodesT_out [index] != node->index_T_out) {
+				valid = false;
+				break;
+			}
+		}
+		if (used.size () <= index) used.resize ((size_t) index + 1, false);
+		if (used [index]) {
+			// two nodes of the genome share the same key
+			valid = false;
+			break;
+		}
+		used [index] = true;
+
+		slotsIndex [slot] = index;
+		genomeNodes.push_back (std::make_pair (index, slot));
+	}
+
+	// operations
+	for (size_t k = 0; valid && k < genomePlan.opeSrc.size (); k++) {
+		const unsigned int src = slotsIndex [genomePlan.opeSrc [k]];
+		const unsigned int dst = slotsIndex [genomePlan.opeDst [k]];
+		if (src == (unsigned int) -1 || dst == (unsigned int) -1) {
+			valid = false;
+			break;
+		}
+		const std::tuple<unsigned int, unsigned int, unsigned int> key = std::make_tuple (src, dst, genomePlan.opeRecu [k]);
+
+		typename std::map<std::tuple<unsigned int, unsigned int, unsigned int>, unsigned int>::iterator it = opesIndex.find (key);
+		unsigned int index;
+		if (it == opesIndex.end ()) {
+			index = (unsigned int) opesSrc.size ();
+			opesIndex.insert (std::make_pair (key, index));
+			opesSrc.push_back (src);
+			opesDst.push_back (dst);
+			opesRecu.push_back (genomePlan.opeRecu [k]);
+			newOpesKeys.push_back (key);
+		} else {
+			index = it->second;
+		}
+		genomeOpes.push_back (std::make_pair (index, genomePlan.opeWeight [k]));
+	}
+
+	// the union of the non-recurrent connections must remain acyclic
+	if (valid && newOpesKeys.size () > 0) {
+		valid = TopologicalOrder (nullptr);
+	}
+
+	if (!valid) {
+		// rollback
+		for (unsigned int key : newNodesKeys) {
+			nodesIndex.erase (key);
+		}
+		for (const std::tuple<unsigned int, unsigned int, unsigned int>& key : newOpesKeys) {
+			opesIndex.erase (key);
+		}
+		nodesT_in.resize (nbNodesBefore);
+		nodesT_out.resize (nbNodesBefore);
+		opesSrc.resize (nbOpesBefore);
+		opesDst.resize (nbOpesBefore);
+		opesRecu.resize (nbOpesBefore);
+		return false;
+	}
+
+	membersNodes.push_back (std::move (genomeNodes));
+	membersOpes.push_back (std::move (genomeOpes));
+	return true;
+}
+
+template <typename... Types>
+bool LockstepNetwork<Types...>::TopologicalOrder (std::vector<unsigned int>* order) {
+	const size_t nbNodes = nodesT_in.size ();
+
+	// adjacency of the non-recurrent operations
+	std::vector<size_t> begin (nbNodes + 1, 0);
+	std::vector<unsigned int> inDegree (nbNodes, 0);
+	for (size_t k = 0; k < opesSrc.size (); k++) {
+		if (opesRecu [k] == 0) {
+			begin [(size_t) opesSrc [k] + 1] ++;
+			inDegree [opesDst [k]] ++;
+		}
+	}
+	for (size_t i = 0; i < nbNodes; i++) {
+		begin [i + 1] += begin [i];
+	}
+	std::vector<unsigned int> successors (begin.back ());
+	std::vector<size_t> cursor (begin.begin (), begin.end () - 1);
+	for (size_t k = 0; k < opesSrc.size (); k++) {
+		if (opesRecu [k] == 0) {
+			successors [cursor [opesSrc [k]] ++] = opesDst [k];
+		}
+	}
+
+	// Kahn's algorithm
+	std::vector<unsigned int> sorted;
+	sorted.reserve (nbNodes);
+	for (unsigned int i = 0; i < (unsigned int) nbNodes; i++) {
+		if (inDegree [i] == 0) sorted.push_back (i);
+	}
+	for (size_t k = 0; k < sorted.size (); k++) {
+		const unsigned int node = sorted [k];
+		for (size_t j = begin [node]; j < begin [(size_t) node + 1]; j++) {
+			if (-- inDegree [successors [j]] == 0) sorted.push_back (successors [j]);
+		}
+	}
+
+	if (sorted.size () != nbNodes) return false;
+	if (order != nullptr) *order = std::move (sorted);
+	return true;
+}
+
+template <typename... Types>
+void LockstepNetwork<Types...>::Build () {
+	const size_t nbLanes = members.size ();
+	const size_t nbNodes = nodesT_in.size ();
+	const size_t nbOpes = opesSrc.size ();
+
+	// lanes's nodes
+	lanesNodes.assign (nbNodes * nbLanes, nullptr);
+	for (size_t lane = 0; lane < nbLanes; lane++) {
+		for (const std::pair<unsigned int, unsigned int>& node : membersNodes [lane]) {
+			lanesNodes [node.first * nbLanes + lane] = members [lane]->plan.slots [node.second];
+		}
+	}
+
+	// layers: longest path from the sources through the non-recurrent operations
+	std::vector<unsigned int> order;
+	TopologicalOrder (&order);
+	std::vector<size_t> layers (nbNodes, 0);
+	std::vector<std::vector<unsigned int>> successors (nbNodes);
+	for (size_t k = 0; k < nbOpes; k++) {
+		if (opesRecu [k] == 0) successors [opesSrc [k]].push_back ((unsigned int) k);
+	}
+	size_t nbLayers = 1;
+	for (unsigned int node : order) {
+		for (unsigned int k : successors [node]) {
+			layers [opesDst [k]] = std::max (layers [opesDst [k]], layers [node] + 1);
+		}
+		nbLayers = std::max (nbLayers, layers [node] + 1);
+	}
+
+	// union nodes
+	nodes.clear ();
+	plan.clear ();
+	for (size_t i = 0; i < nbNodes; i++) {
+		nodes.push_back (CreateNode::get<Types...> (nodesT_in [i], nodesT_out [i]));
+		NodeBase* node = nodes.back ().get ();
+		node->id = (unsigned int) i;
+		node->layer = (int) layers [i];
+		node->index_T_in = nodesT_in [i];
+		node->index_T_out = nodesT_out [i];
+		node->is_useful = true;
+		node->max_depth_recu = 0;
+		for (size_t lane = 0; lane < nbLanes; lane++) {
+			if (lanesNodes [i * nbLanes + lane] != nullptr) {
+				node->max_depth_recu = std::max (node->max_depth_recu, lanesNodes [i * nbLanes + lane]->max_depth_recu);
+			}
+		}
+		node->setResetValue (members [0]->resetValues [nodesT_in [i]]);
+		node->reset (true, false, true);
+		node->setupLanes (nbLanes);
+		if (i < nbBias) {
+			for (size_t lane = 0; lane < nbLanes; lane++) {
+				node->loadInputLane (members [lane]->plan.slots [i]->getInput (), lane);
+			}
+		}
+		plan.slots.push_back (node);
+		if (i >= nbBias + nbInput) plan.resetSlots.push_back ((unsigned int) i);
+	}
+
+	// nodes to process, by layer
+	plan.processLayerBegin.assign (nbLayers + 1, 0);
+	for (size_t i = 0; i < nbNodes; i++) {
+		plan.processLayerBegin [layers [i] + 1] ++;
+	}
+	for (size_t ilayer = 0; ilayer < nbLayers; ilayer++) {
+		plan.processLayerBegin [ilayer + 1] += plan.processLayerBegin [ilayer];
+	}
+	plan.processSlots.resize (nbNodes);
+	std::vector<size_t> cursor (plan.processLayerBegin.begin (), plan.processLayerBegin.end () - 1);
+	for (size_t i = 0; i < nbNodes; i++) {
+		plan.processSlots [cursor [layers [i]] ++] = (unsigned int) i;
+	}
+
+	// operations: non-recurrent ones by source's layer, then recurrent ones by recurrency level
+	plan.opeLayerBegin.assign (nbLayers + 1, 0);
+	std::vector<unsigned int> recurrents;
+	for (size_t k = 0; k < nbOpes; k++) {
+		if (opesRecu [k] == 0) {
+			plan.opeLayerBegin [layers [opesSrc [k]] + 1] ++;
+		} else {
+			recurrents.push_back ((unsigned int) k);
+		}
+	}
+	for (size_t ilayer = 0; ilayer < nbLayers; ilayer++) {
+		plan.opeLayerBegin [ilayer + 1] += plan.opeLayerBegin [ilayer];
+	}
+	std::vector<unsigned int> sorted (plan.opeLayerBegin.back ());
+	cursor.assign (plan.opeLayerBegin.begin (), plan.opeLayerBegin.end () - 1);
+	for (size_t k = 0; k < nbOpes; k++) {
+		if (opesRecu [k] == 0) sorted [cursor [layers [opesSrc [k]]] ++] = (unsigned int) k;
+	}
+	std::stable_sort (recurrents.begin (), recurrents.end (), [this] (unsigned int k1, unsigned int k2) {
+		return opesRecu [k1] < opesRecu [k2];
+	});
+	plan.recuBegin = sorted.size ();
+	sorted.insert (sorted.end (), recurrents.begin (), recurrents.end ());
+
+	std::vector<size_t> position (nbOpes);
+	for (size_t p = 0; p < sorted.size (); p++) {
+		const unsigned int k = sorted [p];
+		position [k] = p;
+		plan.addOperation (opesSrc [k], opesDst [k], opesRecu [k], 0.0);
+	}
+	plan.schedule ();
+
+	// per lane weights and masks
+	opesWeights.assign (nbOpes * nbLanes, 0.0);
+	opesMasks.assign (nbOpes * nbLanes, 0);
+	for (size_t lane = 0; lane < nbLanes; lane++) {
+		for (const std::pair<unsigned int, double>& ope : membersOpes [lane]) {
+			opesWeights [position [ope.first] * nbLanes + lane] = ope.second;
+			opesMasks [position [ope.first] * nbLanes + lane] = 1;
+		}
+	}
+
+	nan.assign (nbLanes, 0);
+}
+
+template <typename... Types>
+void LockstepNetwork<Types...>::run (const std::vector<const std::vector<std::vector<void*>>*>& inputs, bool saveOutputs) {
+	const size_t nbLanes = members.size ();
+	if (nbLanes == 0) return;
+	const size_t N_time = inputs [0]->size ();
+	std::vector<NodeBase*>& slots = plan.slots;
+
+	for (size_t time = 0; time < N_time; time++) {
+		// load inputs
+		for (size_t lane = 0; lane < nbLanes; lane++) {
+			for (unsigned int i = 0; i < nbInput; i++) {
+				slots [nbBias + i]->loadInputLane ((*inputs [lane]) [time][i], lane);
+			}
+		}
+
+		// reset input
+		for (unsigned int slot : plan.resetSlots) {
+			slots [slot]->resetLanes ();
+		}
+
+		// recurrent connections
+		const size_t recuEnd = plan.recuEnd (N_run);
+		for (size_t k = plan.recuBegin; k < recuEnd; k++) {
+			slots [plan.opeDst [k]]->AddToInputLanes (slots [plan.opeSrc [k]], plan.opeRecu [k] - 1, &opesWeights [k * nbLanes], &opesMasks [k * nbLanes]);
+		}
+
+		// layers
+		for (size_t ilayer = 0; ilayer < plan.nbLayers (); ilayer++) {
+			for (size_t k = plan.processLayerBegin [ilayer]; k < plan.processLayerBegin [ilayer + 1]; k++) {
+				slots [plan.processSlots [k]]->processLanes (&lanesNodes [plan.processSlots [k] * nbLanes], nan.data ());
+			}
+
+			for (size_t k = plan.opeLayerBegin [ilayer]; k < plan.opeLayerBegin [ilayer + 1]; k++) {
+				slots [plan.opeDst [k]]->AddToInputLanes (slots [plan.opeSrc [k]], 0, &opesWeights [k * nbLanes], &opesMasks [k * nbLanes]);
+			}
+		}
+		N_run++;
+
+		// members's results
+		for (size_t lane = 0; lane < nbLanes; lane++) {
+			Genome<Types...>* member = members [lane];
+			if (member->locked) continue;
+			if (nan [lane]) {
+				member->locked = true;
+				member->setFitness (0.0);
+				continue;
+			}
+			if (saveOutputs) {
+				for (unsigned int i = nbBias + nbInput; i < nbBias + nbInput + nbOutput; i++) {
+					member->plan.slots [i]->loadLane (slots [i], lane);
+					member->plan.slots [i]->saveOutput ();
+				}
+			}
+		}
+	}
+
+	// leave the members as if they have been run step by step
+	for (size_t lane = 0; lane < nbLanes; lane++) {
+		Genome<Types...>* member = members [lane];
+		if (member->locked || N_time == 0) continue;
+		member->N_runNetwork += (unsigned int) N_time;
+		member->loadInputs (inputs [lane]->back ());
+		for (const std::pair<unsigned int, unsigned int>& node : membersNodes [lane]) {
+			member->plan.slots [node.second]->loadLane (slots [node.first], lane);
+		}
+		member->typed.nodesUpdated ();
+	}
+}
+
+#endif	// LOCKSTEP_NETWORK_HPP
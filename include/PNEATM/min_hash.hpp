@@ -0,0 +1,100 @@
+#ifndef MIN_HASH_HPP
+#define MIN_HASH_HPP
+
+#include <PNEATM/Connection/gene_arrays.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace pneatm {
+
+/**
+ * @brief A class representing MinHash sketches of the enabled innovation IDs of genomes, cut into bands for locality-sensitive hashing.
+ *
+ * The sketch of a set is made of `nbBands * rowsPerBand` minima, each one of the set hashed by a different function: two sets have the same minimum
+ * with a probability equal to their Jaccard similarity J. The minima are grouped in bands of `rowsPerBand` rows, each band being hashed into a key:
+ * two sets share the key of at least one band with a probability of 1 - (1 - J^rowsPerBand)^nbBands, which is high for similar sets and low for different ones.
+ */
+class MinHash {
+public:
+    /**
+     * @brief Constructor for the MinHash class.
+     * @param nbBands The number of bands. (default is 20)
+     * @param rowsPerBand The number of rows per band. (default is 4)
+     */
+    MinHash (unsigned int nbBands = 20, unsigned int rowsPerBand = 4);
+
+    /**
+     * @brief Get the number of bands.
+     * @return The number of bands.
+     */
+    unsigned int getNbBands () const {return nbBands;};
+
+    /**
+     * @brief Get the number of rows per band.
+     * @return The number of rows per band.
+     */
+    unsigned int getRowsPerBand () const {return rowsPerBand;};
+
+    /**
+     * @brief Compute the key of each band of the sketch of the enabled innovation IDs of some genes.
+     * @param genes The genes.
+     * @param keys The array of `getNbBands ()` keys to fill.
+     */
+    void bandKeys (const geneArrays_t& genes, uint64_t* keys) const;
+
+private:
+    unsigned int nbBands;
+    unsigned int rowsPerBand;
+    std::vector<uint64_t> seeds;    // one per hash function
+
+    static uint64_t Mix (uint64_t x);
+};
+
+inline MinHash::MinHash (unsigned int nbBands, unsigned int rowsPerBand) :
+    nbBands (nbBands > 0 ? nbBands : 1),
+    rowsPerBand (rowsPerBand > 0 ? rowsPerBand : 1)
+{
+    // the hash functions only differ by their seed, which are fixed so that the sketches do not depend on the run
+    seeds.resize ((size_t) this->nbBands * this->rowsPerBand);
+    for (size_t i = 0; i < seeds.size (); i++) {
+        seeds [i] = Mix (0x9E3779B97F4A7C15ull * (i + 1));
+    }
+}
+
+inline uint64_t MinHash::Mix (uint64_t x) {
+    // the finalizer of splitmix64
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+inline void MinHash::bandKeys (const geneArrays_t& genes, uint64_t* keys) const {
+    std::vector<uint64_t> minima (seeds.size (), UINT64_MAX);
+    for (size_t k = 0; k < genes.size (); k++) {
+        if (genes.enabled [k]) {
+            const uint64_t innovId = genes.innovIds [k];
+            for (size_t i = 0; i < seeds.size (); i++) {
+                const uint64_t h = Mix (innovId ^ seeds [i]);
+                if (h < minima [i]) {
+                    minima [i] = h;
+                }
+            }
+        }
+    }
+
+    for (unsigned int band = 0; band < nbBands; band++) {
+        uint64_t key = band;
+        for (unsigned int row = 0; row < rowsPerBand; row++) {
+            key = Mix (key ^ minima [(size_t) band * rowsPerBand + row]);
+        }
+        keys [band] = key;
+    }
+}
+
+}
+
+#endif  // MIN_HASH_HPP
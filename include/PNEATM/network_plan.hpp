@@ -0,0 +1,156 @@
+#ifndef NETWORK_PLAN_HPP
+#define NETWORK_PLAN_HPP
+
+#include <PNEATM/Node/node_base.hpp>
+#include <vector>
+#include <cstddef>
+
+namespace pneatm {
+
+/**
+ * @brief Structure representing the compiled execution plan of a genome's network.
+ *
+ * The `networkPlan` struct is a flat, index-based description of everything `runNetwork` has to do.
+ * Nodes are addressed through slots (a slot is the node's id) and operations are stored as a structure of arrays,
+ * grouped per layer, so that running the network is a sequence of linear scans over contiguous memory.
+ * Recurrent operations are sorted by recurrency level and activated through a precomputed schedule.
+ */
+typedef struct networkPlan {
+    /**
+     * @brief Nodes of the network indexed by slot.
+     */
+    std::vector<NodeBase*> slots;
+
+    /**
+     * @brief Slots of the nodes whose input has to be resetted before each run.
+     */
+    std::vector<unsigned int> resetSlots;
+
+    /**
+     * @brief Slots of the nodes to process, grouped by layer.
+     */
+    std::vector<unsigned int> processSlots;
+
+    /**
+     * @brief Nodes of layer `l` are in `processSlots [processLayerBegin [l], processLayerBegin [l + 1])`.
+     */
+    std::vector<size_t> processLayerBegin;
+
+    /**
+     * @brief Source slot of each operation.
+     */
+    std::vector<unsigned int> opeSrc;
+
+    /**
+     * @brief Destination slot of each operation.
+     */
+    std::vector<unsigned int> opeDst;
+
+    /**
+     * @brief Recurrency level of each operation.
+     */
+    std::vector<unsigned int> opeRecu;
+
+    /**
+     * @brief Weight of each operation.
+     */
+    std::vector<double> opeWeight;
+
+    /**
+     * @brief Connection of each operation, used to patch the plan after a mutation.
+     */
+    std::vector<unsigned int> opeConn;
+
+    /**
+     * @brief Non-recurrent operations whose source is in layer `l` are in `[opeLayerBegin [l], opeLayerBegin [l + 1])`.
+     */
+    std::vector<size_t> opeLayerBegin;
+
+    /**
+     * @brief Index of the first recurrent operation. Recurrent operations are stored after the non-recurrent ones, sorted by recurrency level.
+     */
+    size_t recuBegin;
+
+    /**
+     * @brief Activation schedule of the recurrent operations: at the n-th run, the active ones are in `[recuBegin, recuActiveEnd [min (n, recuActiveEnd.size () - 1)])`.
+     */
+    std::vector<size_t> recuActiveEnd;
+
+    /**
+     * @brief Constructor of networkPlan
+     */
+    networkPlan () :
+        recuBegin (0),
+        recuActiveEnd (1, 0)
+    {};
+
+    /**
+     * @brief Get the number of layers.
+     * @return The number of layers.
+     */
+    size_t nbLayers () const {
+        return processLayerBegin.size () > 0 ? processLayerBegin.size () - 1 : 0;
+    }
+
+    /**
+     * @brief Get the end of the active recurrent operations for a given run.
+     * @param N_runNetwork The number of runs already done.
+     * @return The index following the last active recurrent operation.
+     */
+    size_t recuEnd (unsigned int N_runNetwork) const {
+        return N_runNetwork < recuActiveEnd.size () ? recuActiveEnd [N_runNetwork] : recuActiveEnd.back ();
+    }
+
+    /**
+     * @brief Append an operation.
+     * @param src The source slot.
+     * @param dst The destination slot.
+     * @param recu The recurrency level.
+     * @param weight The weight.
+     * @param conn The connection's ID. (default is 0, for plans that are not built from a single genome)
+     */
+    void addOperation (unsigned int src, unsigned int dst, unsigned int recu, double weight, unsigned int conn = 0) {
+        opeSrc.push_back (src);
+        opeDst.push_back (dst);
+        opeRecu.push_back (recu);
+        opeWeight.push_back (weight);
+        opeConn.push_back (conn);
+    }
+
+    /**
+     * @brief Build the activation schedule of the recurrent operations, which must be sorted by recurrency level.
+     */
+    void schedule () {
+        const unsigned int maxRecu = recuBegin < opeRecu.size () ? opeRecu.back () : 0;
+        recuActiveEnd.assign ((size_t) maxRecu + 1, recuBegin);
+        size_t k = recuBegin;
+        for (unsigned int n = 0; n <= maxRecu; n++) {
+            while (k < opeRecu.size () && opeRecu [k] <= n) {
+                k ++;
+            }
+            recuActiveEnd [n] = k;
+        }
+    }
+
+    /**
+     * @brief Clear the plan while keeping its allocated memory.
+     */
+    void clear () {
+        slots.clear ();
+        resetSlots.clear ();
+        processSlots.clear ();
+        processLayerBegin.clear ();
+        opeSrc.clear ();
+        opeDst.clear ();
+        opeRecu.clear ();
+        opeWeight.clear ();
+        opeConn.clear ();
+        opeLayerBegin.clear ();
+        recuBegin = 0;
+        recuActiveEnd.assign (1, 0);
+    }
+} networkPlan_t;
+
+}
+
+#endif	// NETWORK_PLAN_HPP
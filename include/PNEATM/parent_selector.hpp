@@ -0,0 +1,193 @@
+#ifndef PARENT_SELECTOR_HPP
+#define PARENT_SELECTOR_HPP
+
+#include <PNEATM/utils.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace pneatm {
+
+enum selectionPolicy {
+    ROULETTE_SELECTION,
+    ALIAS_SELECTION,
+    TOURNAMENT_SELECTION,
+    TRUNCATION_SELECTION
+};
+
+/**
+ * @brief A class representing the selection of the parents among the members of a species, built once per generation and then sampled many times.
+ *
+ * The candidates are given by their fitness, and a selection returns the index of the chosen one. The random values are drawn from the generator
+ * of the calling thread (see `RandomScope`), so that a built selector can be sampled by several threads at once.
+ */
+class ParentSelector {
+public:
+    /**
+     * @brief Constructor for the ParentSelector class, giving a selector without candidate.
+     */
+    ParentSelector () :
+        policy (ROULETTE_SELECTION),
+        tournamentSize (3),
+        nbCandidates (0),
+        total (0.0)
+    {};
+
+    /**
+     * @brief Build the selector.
+     * @param fitnesses The fitness of each candidate.
+     * @param policy The selection policy:\n	- `ROULETTE_SELECTION`: a candidate is chosen with a probability proportional to its fitness, by a binary search in the cumulated fitnesses\n	- `ALIAS_SELECTION`: the same probabilities, sampled in constant time from Walker's alias table\n	- `TOURNAMENT_SELECTION`: the fitter of `tournamentSize` candidates chosen uniformly\n	- `TRUNCATION_SELECTION`: a candidate chosen uniformly among the fitter ones (default is ROULETTE_SELECTION)
+     * @param tournamentSize The number of candidates of a tournament [for TOURNAMENT_SELECTION only]. (default is 3)
+     * @param truncationRate The proportion of the candidates which can be chosen [for TRUNCATION_SELECTION only]. (default is 0.5)
+     *
+     * If every fitness is null, `ROULETTE_SELECTION` and `ALIAS_SELECTION` choose a candidate uniformly.
+     */
+    void build (const std::vector<double>& fitnesses, selectionPolicy policy = ROULETTE_SELECTION, unsigned int tournamentSize = 3, double truncationRate = 0.5);
+
+    /**
+     * @brief Get the number of candidates.
+     * @return The number of candidates.
+     */
+    size_t size () const {return nbCandidates;};
+
+    /**
+     * @brief Choose a candidate, which needs at least one candidate.
+     * @return The index of the chosen candidate.
+     */
+    unsigned int select () const;
+
+private:
+    selectionPolicy policy;
+    unsigned int tournamentSize;
+    size_t nbCandidates;
+    double total;   // the sum of the fitnesses [for ROULETTE_SELECTION and ALIAS_SELECTION only]
+    std::vector<double> fitnesses;  // [for TOURNAMENT_SELECTION only]
+    std::vector<double> cumulated;  // the running sum of the fitnesses [for ROULETTE_SELECTION only]
+    std::vector<double> probs;  // the probability to keep each column of the alias table [for ALIAS_SELECTION only]
+    std::vector<unsigned int> aliases;  // [for ALIAS_SELECTION only]
+    std::vector<unsigned int> ranked;   // the candidates from the fitter one [for TRUNCATION_SELECTION only], then the scratch of the alias table
+
+    void BuildAliases ();
+};
+
+inline void ParentSelector::build (const std::vector<double>& fitnesses, selectionPolicy policy, unsigned int tournamentSize, double truncationRate) {
+    this->policy = policy;
+    this->tournamentSize = tournamentSize > 0 ? tournamentSize : 1;
+    nbCandidates = fitnesses.size ();
+
+    switch (policy) {
+        case ROULETTE_SELECTION:
+            // summed in the order of the candidates, so that the last running sum is the species' fitness sum
+            cumulated.resize (nbCandidates);
+            total = 0.0;
+            for (size_t i = 0; i < nbCandidates; i++) {
+                total += fitnesses [i];
+                cumulated [i] = total;
+            }
+            break;
+        case ALIAS_SELECTION:
+            this->fitnesses.assign (fitnesses.begin (), fitnesses.end ());
+            BuildAliases ();
+            break;
+        case TOURNAMENT_SELECTION:
+            this->fitnesses.assign (fitnesses.begin (), fitnesses.end ());
+            break;
+        case TRUNCATION_SELECTION: {
+            ranked.resize (nbCandidates);
+            for (unsigned int i = 0; i < (unsigned int) nbCandidates; i++) {
+                ranked [i] = i;
+            }
+            std::stable_sort (ranked.begin (), ranked.end (), [&] (unsigned int i1, unsigned int i2) {
+                return fitnesses [i1] > fitnesses [i2];
+            });
+            const size_t kept = (size_t) std::ceil (truncationRate * (double) nbCandidates);
+            ranked.resize (std::max ((size_t) 1, std::min (kept, nbCandidates)));
+            break;
+        }
+    }
+}
+
+inline void ParentSelector::BuildAliases () {
+    // Vose's construction: each column holds the probability of a candidate, topped up by the one of its alias
+    total = 0.0;
+    for (double& fitness : fitnesses) {
+        fitness = std::max (fitness, 0.0);
+        total += fitness;
+    }
+    probs.resize (nbCandidates);
+    aliases.resize (nbCandidates);
+    if (Eq_Double (total, 0.0)) {
+        return;
+    }
+
+    ranked.clear ();    // the small columns from the front, the large ones from the back
+    ranked.resize (nbCandidates);
+    size_t nbSmall = 0;
+    size_t firstLarge = nbCandidates;
+    for (unsigned int i = 0; i < (unsigned int) nbCandidates; i++) {
+        probs [i] = fitnesses [i] * (double) nbCandidates / total;
+        aliases [i] = i;
+        if (probs [i] < 1.0) {
+            ranked [nbSmall++] = i;
+        } else {
+            ranked [--firstLarge] = i;
+        }
+    }
+    while (nbSmall > 0 && firstLarge < nbCandidates) {
+        const unsigned int small = ranked [--nbSmall];
+        const unsigned int large = ranked [firstLarge];
+        aliases [small] = large;
+        probs [large] -= 1.0 - probs [small];
+        if (probs [large] < 1.0) {
+            firstLarge ++;
+            ranked [nbSmall++] = large;
+        }
+    }
+    // the columns left are full, up to the rounding errors
+    for (size_t k = 0; k < nbSmall; k++) {
+        probs [ranked [k]] = 1.0;
+    }
+    for (size_t k = firstLarge; k < nbCandidates; k++) {
+        probs [ranked [k]] = 1.0;
+    }
+}
+
+inline unsigned int ParentSelector::select () const {
+    switch (policy) {
+        case ROULETTE_SELECTION: {
+            if (Eq_Double (total, 0.0)) {
+                // everyone as a null fitness: we return a random candidate
+                return Random_UInt (0, (unsigned int) nbCandidates - 1);
+            }
+            // the first candidate whose running sum is greater than the random value
+            const double randThresh = Random_Double (0.0, total, true, false);
+            const size_t i = (size_t) (std::upper_bound (cumulated.begin (), cumulated.end (), randThresh) - cumulated.begin ());
+            return (unsigned int) std::min (i, nbCandidates - 1);
+        }
+        case ALIAS_SELECTION: {
+            const unsigned int i = Random_UInt (0, (unsigned int) nbCandidates - 1);
+            if (Eq_Double (total, 0.0)) {
+                return i;
+            }
+            return Random_Double (0.0, 1.0, true, false) < probs [i] ? i : aliases [i];
+        }
+        case TOURNAMENT_SELECTION: {
+            unsigned int best = Random_UInt (0, (unsigned int) nbCandidates - 1);
+            for (unsigned int k = 1; k < tournamentSize; k++) {
+                const unsigned int i = Random_UInt (0, (unsigned int) nbCandidates - 1);
+                if (fitnesses [i] > fitnesses [best]) {
+                    best = i;
+                }
+            }
+            return best;
+        }
+        case TRUNCATION_SELECTION:
+            return ranked [Random_UInt (0, (unsigned int) ranked.size () - 1)];
+    }
+    return 0;   // impossible
+}
+
+}
+
+#endif  // PARENT_SELECTOR_HPP
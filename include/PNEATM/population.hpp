@@ -3,6 +3,7 @@
 
 #include <PNEATM/genome.hpp>
 #include <PNEATM/species.hpp>
+#include <PNEATM/lockstep_network.hpp>
 #include <PNEATM/Connection/connection.hpp>
 #include <PNEATM/Connection/innovation_connection.hpp>
 #include <PNEATM/Node/innovation_node.hpp>
@@ -10,15 +11,24 @@
 #include <PNEATM/Node/Activation_Function/create_activation_function.hpp>
 #include <PNEATM/thread_pool.hpp>
 #include <PNEATM/utils.hpp>
+#include <PNEATM/random.hpp>
+#include <PNEATM/min_hash.hpp>
+#include <PNEATM/vp_tree.hpp>
+#include <PNEATM/parent_selector.hpp>
 #include <fstream>
 #include <iostream>
 #include <cstring>
 #include <limits>
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
+#include <map>
 #include <memory>
 #include <functional>
 #include <thread>
+#include <cstdint>
+#include <chrono>
+#include <cmath>
 #ifndef PURE_CPP
 	#include <spdlog/spdlog.h>
 #else
@@ -29,6 +39,23 @@
 
 namespace pneatm {
 
+/**
+ * @brief Structure given to the evaluation function of `Population::evaluate`.
+ */
+typedef struct evalContext {
+	unsigned int genomeId;	// the ID of the evaluated genome
+	unsigned int worker;	// the index of the thread evaluating the genome
+	std::shared_ptr<void> environment;	// the environment of this thread (nullptr if there is no environment factory)
+
+	/**
+	 * @brief Get the environment of this thread.
+	 * @tparam T The type of the environment built by the factory.
+	 * @return A reference to the environment.
+	 */
+	template <typename T>
+	T& getEnvironment () {return *static_cast<T*> (environment.get ());}
+} evalContext_t;
+
 /**
  * @brief A template class representing a population.
  * @tparam Types Variadic template arguments that contains all the manipulated types.
@@ -58,6 +85,8 @@ class Population {
 		 * @param speciationThreshInit The initial speciation threshold. (default is 20.0)
 		 * @param threshGensSinceImproved The maximum number of generations without any improvement. (default is 15)
 		 * @param stats_filename The filename for statistics. (default is an empty string, which doesn't create any file)
+		 *
+		 * The seed of the population's random streams is drawn from `rand()`: `srand` still seeds the whole evolution.
 		 */
 		Population (unsigned int popSize, const std::vector<size_t>& bias_sch, const std::vector<size_t>& inputs_sch, const std::vector<size_t>& outputs_sch, const std::vector<std::vector<size_t>>& hiddens_sch_init, const std::vector<void*>& bias_values, const std::vector<void*>& resetValues, const std::vector<std::vector<std::vector<ActivationFnBase*>>>& activationFns, const std::vector<ActivationFnBase*> inputsActivationFns, const std::vector<ActivationFnBase*> outputsActivationFns, unsigned int N_ConnInit, double probRecuInit, double weightExtremumInit, unsigned int maxRecuInit, spdlog::logger* logger, const std::vector<genomeStruct_t>& specific_genomes = {}, distanceFn dstType = CONVENTIONAL, double speciationThreshInit = 20.0, unsigned int threshGensSinceImproved = 15, const std::string& stats_filename = "");
 
@@ -87,6 +116,65 @@ class Population {
 		 */
 		unsigned int getGeneration () {return generation;};
 
+		/**
+		 * @brief Get the seed of the population's random streams.
+		 * @return The seed.
+		 */
+		uint64_t getSeed () {return seed;};
+
+		/**
+		 * @brief Set the seed of the population's random streams.
+		 * @param seed The seed.
+		 *
+		 * Every random draw of the population comes from a stream given by the seed, the generation and the genome (or the step, e.g. the speciation),
+		 * so that the evolution only depends on the seed, whatever the number of threads.
+		 */
+		void setSeed (uint64_t seed) {this->seed = seed;};
+
+		/**
+		 * @brief Set how the genomes are compared to the species during the speciation.
+		 * @param policy The speciation policy:\n	- `EXACT_SPECIATION`: each genome is compared to every species\n	- `LSH_SPECIATION`: each genome is only compared to the species whose leader shares a MinHash band with it (see MinHash), for very large populations\n	- `INDEXED_SPECIATION`: the species' leaders are indexed in a vantage-point tree (see VPTree), each genome being only compared to the ones which could be closer than the threshold, with the same result as `EXACT_SPECIATION`. It needs the `EUCLIDIAN` distance and only pays off when the species are well apart from each other
+		 * @param nbBands The number of MinHash bands [for LSH_SPECIATION only]. (default is 20)
+		 * @param rowsPerBand The number of rows per MinHash band [for LSH_SPECIATION only]. (default is 4)
+		 * @param nbRecallSamples The number of genomes compared to every species at the end of each speciation, to measure the recall [for LSH_SPECIATION only]. (default is 64)
+		 *
+		 * The policy is not saved with the population.
+		 */
+		void setSpeciationPolicy (speciationPolicy policy, unsigned int nbBands = 20, unsigned int rowsPerBand = 4, unsigned int nbRecallSamples = 64);
+
+		/**
+		 * @brief Get the recall of the last speciation.
+		 * @return The proportion of the sampled genomes whose closest species was among the ones they have been compared to, -1.0 if it has not been measured.
+		 */
+		double getSpeciationRecall () {return speciationRecall;};
+
+		/**
+		 * @brief Set how the parents of the new genomes are chosen among the members of their species.
+		 * @param policy The selection policy:\n	- `ROULETTE_SELECTION`: a genome is chosen with a probability proportional to its fitness\n	- `ALIAS_SELECTION`: the same probabilities, sampled in constant time rather than by a binary search, for very large species\n	- `TOURNAMENT_SELECTION`: the fitter of `tournamentSize` members chosen uniformly\n	- `TRUNCATION_SELECTION`: a member chosen uniformly among the fitter ones
+		 * @param tournamentSize The number of members of a tournament [for TOURNAMENT_SELECTION only]. (default is 3)
+		 * @param truncationRate The proportion of the fitter members of a species which can be chosen [for TRUNCATION_SELECTION only]. (default is 0.5)
+		 *
+		 * The selection of each species is built once per generation (see ParentSelector). The policy is not saved with the population.
+		 */
+		void setSelectionPolicy (selectionPolicy policy, unsigned int tournamentSize = 3, double truncationRate = 0.5) {selectionMode = policy; this->tournamentSize = tournamentSize; this->truncationRate = truncationRate;};
+
+		/**
+		 * @brief Set how many genomes are kept by the elitism.
+		 * @param nbElites The number of fitter genomes carried over unchanged to the new generation when the elitism is on. (default is 1)
+		 *
+		 * The elites are moved to the first IDs of the new generation rather than cloned: they keep their optimized network and their fitness,
+		 * so that they do not need to be evaluated again (see isElite), while their memory is reset. A locked genome is never kept.
+		 * The number of elites is not saved with the population.
+		 */
+		void setElitism (unsigned int nbElites) {this->nbElites = nbElites;};
+
+		/**
+		 * @brief Know if a genome has been carried over unchanged by the elitism at the last generation.
+		 * @param genomeId The genome's ID.
+		 * @return True if the genome is an elite of the previous generation, its fitness being still the one it has been given, otherwise false.
+		 */
+		bool isElite (unsigned int genomeId) const {return genomeId < nbElitesKept;};
+
 		/**
 		 * @brief Get the average fitness.
 		 * @return The average fitness.
@@ -212,6 +300,29 @@ class Population {
 		 */
 		void run (const std::vector<std::vector<std::vector<void*>>>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs = nullptr, unsigned int maxThreads = 0, bool flip_outputs = false);
 
+		/**
+		 * @brief Run multiple times the networks over the inputs, species by species. The inputs are shared among the genomes.
+		 * @param inputs The inputs.
+		 * @param outputs Pointer to the outputs. (default is nullptr which doesn't track any output)
+		 * @param maxThreads Maximum number of threads. (default is 0 which default to the number of cores)
+		 * @param flip_outputs If `true`, the outputs's vectors looks like outputs [output_ID][time]. Else, it looks like outputs[time][output_ID]. (defult is `false`)
+		 *
+		 * The members of each species found by the last call to `speciate` are merged into a single network and run in lockstep, one lane per member.
+		 * Genomes that cannot be merged are run on their own. Results are the ones of `run` up to the order in which each node sums its inputs, which changes the roundings (or the truncations for integral types).
+		 */
+		void runLockstep (const std::vector<std::vector<void*>>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs = nullptr, unsigned int maxThreads = 0, bool flip_outputs = false);
+
+		/**
+		 * @brief Run multiple times the networks over the inputs, species by species. The inputs are different for each genomes.
+		 * @param inputs The inputs.
+		 * @param outputs Pointer to the outputs. (default is nullptr which doesn't track any output)
+		 * @param maxThreads Maximum number of threads. (default is 0 which default to the number of cores)
+		 * @param flip_outputs If `true`, the outputs's vectors looks like outputs [output_ID][time]. Else, it looks like outputs[time][output_ID]. (defult is `false`)
+		 *
+		 * Only the members of a species that have sequences of the same length are run together. See `runLockstep` with shared inputs.
+		 */
+		void runLockstep (const std::vector<std::vector<std::vector<void*>>>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs = nullptr, unsigned int maxThreads = 0, bool flip_outputs = false);
+
 		/**
 		 * @brief Run multiple times the networks by looping the outputs and inputs e.g. the n-th outputs is the n+1-th inputs.
 		 * @param N_runs The number of networks's runs e.g. the number of loop.
@@ -221,6 +332,18 @@ class Population {
 		 */
 		void run (const unsigned int N_runs, std::vector<std::vector<std::vector<void*>>>* outputs = nullptr, unsigned int maxThreads = 0, bool flip_outputs = false);
 
+		/**
+		 * @brief Evaluate every genome in parallel and set their fitness.
+		 * @param evaluationFn The evaluation function: it runs a genome (e.g. in a closed-loop environment) and returns its fitness.
+		 * @param maxThreads Maximum number of threads. (default is 0 which default to the number of cores)
+		 * @param environmentFactory A function building an environment. Each thread builds its own one at its first evaluation and gets it through the context. (default is nullptr which builds no environment)
+		 *
+		 * The evaluation function of a thread is never called concurrently, but it is called from several threads: it should only share read-only data between genomes, the rest being in the environment.
+		 * If the evaluation function or the environment factory throws, the genomes not started yet are skipped and the first exception is rethrown once
+		 * every thread is done; no fitness is then set, every genome keeping the fitness it had before the call.
+		 */
+		void evaluate (const std::function<double (Genome<Types...>&, evalContext_t&)>& evaluationFn, unsigned int maxThreads = 0, const std::function<std::shared_ptr<void> ()>& environmentFactory = nullptr);
+
 		/**
 		 * @brief Run the network of the entire population.
 		 * @param maxThreads Maximum number of threads. (default is 0 which default to the number of cores)
@@ -284,7 +407,7 @@ class Population {
 		/**
 		 * @brief Assign genomes to species based on their similarity.
 		 * @param target The target number of species. (default is 5)
-		 * @param maxIterationsReachTarget The maximum number of iterations to reach the target species count. (default is 100)
+		 * @param maxIterationsReachTarget The maximum number of steps the speciation threshold can be adjusted by to reach the target species count. (default is 100)
 		 * @param stepThresh The stepsize for adjusting the speciation threshold. (default is 0.3)
 		 * @param a Coefficient for computing the excess genes contribution to the distance [for CONVENTIONAL distance only]. (default is 1.0)
 		 * @param b Coefficient for computing the disjoint genes contribution to the distance [for CONVENTIONAL distance only]. (default is 1.0)
@@ -292,12 +415,15 @@ class Population {
 		 * @param speciesSizeEvolutionMax The maximum factor of the species's size evolution. (default is 3.0)
 		 * @param speciesSizeEvolutionMin The minimum factor of the species's size evolution. (default is 0.33)
 		 * @param speciesSizeLimit The maximum factor, relatively to the target size, of the species's size. (default is 1.75)
+		 *
+		 * A genome stays in its previous species if it is still closer to it than the threshold, otherwise it joins the closest species or founds a new one.
+		 * The distances are computed once, in parallel, and reused to search by bisection the number of steps giving the target species count.
 		 */
 		void speciate (unsigned int target = 5, unsigned int maxIterationsReachTarget = 100, double stepThresh = 0.3, double a = 1.0, double b = 1.0, double c = 0.4, double speciesSizeEvolutionMax = 3.0, double speciesSizeEvolutionMin = 0.33, double speciesSizeLimit = 1.75);
 
 		/**
 		 * @brief Perform crossover operation to create the new generation.
-		 * @param elitism Set to true to keep the fitter genome in the new generation. (default is false)
+		 * @param elitism Set to true to carry over the fitter genomes unchanged to the new generation (see setElitism). (default is false)
 		 * @param crossover_rate The probability of performing crossover for each new genome. (default is 0.9)
 		 */
 		void crossover (bool elitism = false, double crossover_rate = 0.9);
@@ -310,22 +436,24 @@ class Population {
 
 		/**
 		 * @brief Perform mutation operations for the entire population.
-		 * @param paramsMap A function that returns mutation parameters relative to the genome's fitness.
+		 * @param paramsMap A function that returns mutation parameters relative to the genome's fitness. It is called concurrently, the genomes being mutated in parallel.
 		 */
 		void mutate (const std::function<mutationParams_t (double)>& paramsMap);
 
 		/**
 		 * @brief Build the next generation. Actually, each new genome is the result of a crossover between two parents from the current generation or a mutation of a genome of the curretnt generation.
+		 *
+		 * The new genomes are built in parallel by the population's threads, the innovation trackers being shared by all of them.
 		 * @param mutationParams Mutation parameters.
-		 * @param elitism Set to true to keep the fitter genome in the new generation. (default is false)
+		 * @param elitism Set to true to carry over the fitter genomes unchanged to the new generation (see setElitism). (default is false)
 		 * @param crossover_rate The probability of performing crossover for each new genome. (default is 0.9)
 		 */
 		void buildNextGen (const mutationParams_t& mutationParams, bool elitism = false, double crossover_rate = 0.9);
 
 		/**
 		 * @brief Build the next generation. Actually, each new genome is the result of a crossover between two parents from the current generation or a mutation of a genome of the curretnt generation.
-		 * @param mutationParamsMap A function that returns mutation parameters relative to the genome's fitness.
-		 * @param elitism Set to true to keep the fitter genome in the new generation. (default is false)
+		 * @param mutationParamsMap A function that returns mutation parameters relative to the genome's fitness. It is called concurrently, the new genomes being built in parallel.
+		 * @param elitism Set to true to carry over the fitter genomes unchanged to the new generation (see setElitism). (default is false)
 		 * @param crossover_rate The probability of performing crossover for each new genome. (default is 0.9)
 		 */
 		void buildNextGen (const std::function<mutationParams_t (double)>& mutationParamsMap, bool elitism = false, double crossover_rate = 0.9);
@@ -383,7 +511,37 @@ class Population {
 		auto end () {return genomes.end ();}
 
 	private:
+		enum randomStream {INIT_STREAM, SPECIATION_STREAM, REPRODUCTION_STREAM, MUTATION_STREAM};
+
+		typedef struct speciationCache {
+			std::vector<double> previousDistances;	// distance of each genome to its previous species, -1 if it has none
+			std::vector<std::vector<double>> distances;	// distance of each genome to each species, a row being computed when needed
+			std::vector<std::vector<double>> foundersDistances;	// distance of a new species' founder to each genome, computed when needed
+			std::vector<int> assignment;	// the species of each genome
+			std::vector<unsigned int> founders;	// the founder of each new species
+			std::vector<uint64_t> genomesKeys;	// the MinHash band keys of each genome [for LSH_SPECIATION only]
+			std::vector<std::unordered_map<uint64_t, std::vector<unsigned int>>> speciesBuckets;	// for each band, the species by key [for LSH_SPECIATION only]
+			std::vector<std::unordered_map<uint64_t, std::vector<unsigned int>>> genomesBuckets;	// for each band, the genomes by key [for LSH_SPECIATION only]
+			std::vector<std::vector<unsigned int>> shortlists;	// the species sharing a band with each genome, compared to every species if empty [for LSH_SPECIATION only]
+			VPTree speciesIndex;	// the alive species, by a lower bound of the distance to their leader [for EUCLIDIAN and INDEXED_SPECIATION only]
+			std::vector<double> searchedBounds;	// the distance under which the closest species of each genome has been searched in the index [for EUCLIDIAN and INDEXED_SPECIATION only]
+			std::vector<unsigned int> toCompare;	// the genomes to compare to every species at the current threshold
+			std::vector<unsigned int> toSearch;	// the genomes to search in the index at the current threshold
+			std::vector<std::pair<unsigned int, unsigned int>> pairs;	// the (genome, species) distances to compute at the current threshold
+		} speciationCache_t;
+
+		typedef struct reproductionCache {
+			std::vector<unsigned int> speciesAlive;
+			std::vector<unsigned int> offspringsSpecies;	// the species of each offspring
+			std::vector<std::unique_ptr<Genome<Types...>>> offsprings;
+			std::vector<std::unique_ptr<Genome<Types...>>> retiredGenomes;	// the genomes of the previous generation, overwritten by the next offsprings
+			std::vector<unsigned int> elites;	// the genomes carried over, from the fitter one
+			std::vector<double> fitnesses;	// the fitness of the members of a species
+			std::vector<ParentSelector> selectors;	// the selection of the parents of each species
+		} reproductionCache_t;
+
 		unsigned int generation;
+		uint64_t seed;
 		double avgFitness;
 		double avgFitnessAdjusted;
 		unsigned int popSize;
@@ -403,7 +561,16 @@ class Population {
 		unsigned int maxRecuInit;
 
 		distanceFn dstType;
-
+		speciationPolicy speciationMode;
+		MinHash minHash;
+		unsigned int nbRecallSamples;
+		double speciationRecall;
+
+		selectionPolicy selectionMode;
+		unsigned int tournamentSize;
+		double truncationRate;
+		unsigned int nbElites;
+		unsigned int nbElitesKept;	// the elites of the last generation are the genomes 0 to nbElitesKept - 1
 		int fittergenome_id;
 		std::unordered_map <unsigned int, std::unique_ptr<Genome<Types...>>> genomes;
 		std::vector<Species<Types...>> species;
@@ -415,10 +582,27 @@ class Population {
 
 		spdlog::logger* logger;
 		std::ofstream statsFile;
+		ThreadPool pool;	// started once, shared by every parallel pass of the population
+		speciationCache_t speciationCache;	// kept from a generation to the next one, so that its containers keep their memory
+		reproductionCache_t reproductionCache;	// kept from a generation to the next one, so that its containers keep their memory
 
 		std::unordered_map <unsigned int, Connection> GetWeightedCentroid (unsigned int speciesId);
+		void HashGenes (speciationCache_t& cache);
+		bool IsIndexed () const {return dstType == EUCLIDIAN && speciationMode == INDEXED_SPECIATION;};
+		void IndexSpecies (speciationCache_t& cache);
+		std::vector<unsigned int> Shortlist (const speciationCache_t& cache, const std::vector<std::unordered_map<uint64_t, std::vector<unsigned int>>>& buckets, unsigned int genomeId) const;
+		unsigned int AssignSpecies (speciationCache_t& cache, double thresh, double a, double b, double c);
+		void MeasureRecall (const speciationCache_t& cache, unsigned int species_len, double a, double b, double c);
 		void UpdateFitnesses (double speciesSizeEvolutionMax, double speciesSizeEvolutionMin, double speciesSizeLimit, unsigned int NspeciesTarget);
-		int SelectParent (unsigned int iSpe);
+		unsigned int SelectParent (unsigned int iSpe) const;
+		template <typename Func>
+		void Reproduce (bool elitism, double crossover_rate, Func&& mutateOffspring);
+		Philox Stream (randomStream purpose, unsigned int index = 0) const {return Philox (seed, purpose, generation, index);};
+		void RenumberInnovations (unsigned int firstConnId, unsigned int firstNodeId);
+		void RunLockstep (const std::vector<const std::vector<std::vector<void*>>*>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs, unsigned int maxThreads, bool flip_outputs);
+		std::vector<double> EstimateCosts (const std::vector<size_t>& steps);
+		template <typename Func>
+		void RunGenomes (const std::vector<size_t>& steps, unsigned int maxThreads, Func&& func);
 
 };
 
@@ -445,6 +629,14 @@ Population<Types...>::Population (unsigned int popSize, const std::vector<size_t
 	weightExtremumInit (weightExtremumInit),
 	maxRecuInit (maxRecuInit),
 	dstType (dstType),
+	speciationMode (EXACT_SPECIATION),
+	nbRecallSamples (0),
+	speciationRecall (-1.0),
+	selectionMode (ROULETTE_SELECTION),
+	tournamentSize (3),
+	truncationRate (0.5),
+	nbElites (1),
+	nbElitesKept (0),
 	activationFns (activationFns),
 	inputsActivationFns (inputsActivationFns),
 	outputsActivationFns (outputsActivationFns),
@@ -459,6 +651,7 @@ Population<Types...>::Population (unsigned int popSize, const std::vector<size_t
 	}
 
 	generation = 0;
+	seed = ((uint64_t) rand () << 32) ^ (uint64_t) rand ();
 	fittergenome_id = -1;
 	avgFitness = 0.0;
 	avgFitnessAdjusted = 0.0;
@@ -466,9 +659,11 @@ Population<Types...>::Population (unsigned int popSize, const std::vector<size_t
 	genomes.reserve (popSize);
 	unsigned int genome_id = 0;
 	for (const genomeStruct_t& genome_struct : specific_genomes) {
+		RandomScope random (Stream (INIT_STREAM, genome_id));
 		genomes.insert (std::make_pair (genome_id, std::make_unique<Genome<Types...>> (genome_id, genome_struct, bias_sch, inputs_sch, outputs_sch, bias_values, resetValues, activationFns, inputsActivationFns, outputsActivationFns, &conn_innov, &node_innov, weightExtremumInit, logger)));
 	}
 	for (unsigned int i = genome_id; i < popSize; i++) {
+		RandomScope random (Stream (INIT_STREAM, i));
 		genomes.insert (std::make_pair (i, std::make_unique<Genome<Types...>> (i, bias_sch, inputs_sch, outputs_sch, hiddens_sch_init, bias_values, resetValues, activationFns, inputsActivationFns, outputsActivationFns, &conn_innov, &node_innov, N_ConnInit, probRecuInit, weightExtremumInit, maxRecuInit, logger)));
 	}
 }
@@ -477,6 +672,14 @@ template <typename... Types>
 Population<Types...>::Population (const std::string& filename, const std::vector<void*>& bias_values, const std::vector<void*>& resetValues, const std::vector<std::vector<std::vector<ActivationFnBase*>>>& activationFns, const std::vector<ActivationFnBase*> inputsActivationFns, const std::vector<ActivationFnBase*> outputsActivationFns, spdlog::logger* logger, const std::string& stats_filename) :
 	bias_values (bias_values),
 	resetValues (resetValues),
+	speciationMode (EXACT_SPECIATION),
+	nbRecallSamples (0),
+	speciationRecall (-1.0),
+	selectionMode (ROULETTE_SELECTION),
+	tournamentSize (3),
+	truncationRate (0.5),
+	nbElites (1),
+	nbElitesKept (0),
 	activationFns (activationFns),
 	inputsActivationFns (inputsActivationFns),
 	outputsActivationFns (outputsActivationFns),
@@ -499,6 +702,17 @@ Population<Types...>::~Population () {
 	if (statsFile.is_open ()) statsFile.close ();
 }
 
+template <typename... Types>
+void Population<Types...>::setSpeciationPolicy (speciationPolicy policy, unsigned int nbBands, unsigned int rowsPerBand, unsigned int nbRecallSamples) {
+	if (policy == INDEXED_SPECIATION && dstType != EUCLIDIAN) {
+		logger->warn ("The indexed speciation needs the euclidian distance: every species will be compared instead");
+	}
+	speciationMode = policy;
+	minHash = MinHash (nbBands, rowsPerBand);
+	this->nbRecallSamples = nbRecallSamples;
+	speciationRecall = -1.0;
+}
+
 template <typename... Types>
 Genome<Types...>& Population<Types...>::getGenome (int id) {
 	if (id < 0 || id >= (int) popSize) {
@@ -580,210 +794,202 @@ void Population<Types...>::loadInput (void* input, unsigned int input_id, unsign
 
 template <typename... Types>
 void Population<Types...>::run (const std::vector<std::vector<void*>>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs, unsigned int maxThreads, bool flip_outputs) {
+	const std::vector<size_t> steps (popSize, inputs.size ());
 	if (outputs != nullptr) {
 		// we do care of outputs
-
-		ThreadPool<std::vector<std::vector<void*>>> pool (maxThreads);
-
-		// the task
-		std::function<std::vector<std::vector<void*>> (Genome<Types...>*, std::vector<std::vector<void*>>&)> func = [&] (Genome<Types...>* genome, std::vector<std::vector<void*>>& inputs_gen) -> std::vector<std::vector<void*>> {
-			if (inputs_gen.size () <= 0) return {};
-			for (const std::vector<void*>& inputs_cur : inputs_gen) {
-				genome->loadInputs (inputs_cur);
-				if (!genome->runNetwork ()) return {};
-				genome->saveOutputs ();
-			}
-			return genome->getSavedOutputs (flip_outputs);
-		};
-
-		// fill the thread pool
-		std::vector<std::future<std::vector<std::vector<void*>>>> results;
-		results.reserve (popSize);
-		for (unsigned int i = 0; i < popSize; i++) {
-			// add the task to the pool
-			results.emplace_back (pool.enqueue (
-				func,
-				genomes [i].get (),
-				inputs
-			));
-		}
-
-		// wait for tasks end
-		for (const std::future<std::vector<std::vector<void*>>>& result : results) {
-			result.wait ();
-		}
-
-		// get results
-		outputs->clear ();
-		for (std::future<std::vector<std::vector<void*>>>& result : results) {
-			outputs->push_back (result.get ());
-		}
+		outputs->assign (popSize, {});
+		RunGenomes (steps, maxThreads, [&] (Genome<Types...>* genome, size_t i) {
+			if (inputs.size () <= 0) return;
+			if (!genome->RunSequence (inputs, true)) return;
+			(*outputs) [i] = genome->getSavedOutputs (flip_outputs);
+		});
 
 	} else {
 		// we don't care of outputs
-		UNUSED (outputs);
-
-		ThreadPool<void> pool (maxThreads);
+		RunGenomes (steps, maxThreads, [&] (Genome<Types...>* genome, size_t i) {
+			UNUSED (i);
+			genome->RunSequence (inputs, false);
+		});
+	}
+}
 
-		// the task
-		std::function<void (Genome<Types...>*, std::vector<std::vector<void*>>&)> func = [&] (Genome<Types...>* genome, std::vector<std::vector<void*>>& inputs_gen) -> void {
-			for (const std::vector<void*>& inputs_cur : inputs_gen) {
-				genome->loadInputs (inputs_cur);
-				if (!genome->runNetwork ()) return;
-			}
-		};
+template <typename... Types>
+void Population<Types...>::run (const std::vector<std::vector<std::vector<void*>>>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs, unsigned int maxThreads, bool flip_outputs) {
+	std::vector<size_t> steps (popSize);
+	for (unsigned int i = 0; i < popSize; i++) {
+		steps [i] = inputs [i].size ();
+	}
+	if (outputs != nullptr) {
+		// we do care of outputs
+		outputs->assign (popSize, {});
+		RunGenomes (steps, maxThreads, [&] (Genome<Types...>* genome, size_t i) {
+			if (inputs [i].size () <= 0) return;
+			if (!genome->RunSequence (inputs [i], true)) return;
+			(*outputs) [i] = genome->getSavedOutputs (flip_outputs);
+		});
 
-		// fill the thread pool
-		for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-			// add the task to the pool
-			pool.enqueue (
-				func,
-				genome.second.get (),
-				inputs
-			);
-		}
+	} else {
+		// we don't care of outputs
+		RunGenomes (steps, maxThreads, [&] (Genome<Types...>* genome, size_t i) {
+			genome->RunSequence (inputs [i], false);
+		});
+	}
+}
 
-		// will wait for the end of all tasks as ~ThreadPool () will be called
+template <typename... Types>
+void Population<Types...>::runLockstep (const std::vector<std::vector<void*>>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs, unsigned int maxThreads, bool flip_outputs) {
+	RunLockstep (std::vector<const std::vector<std::vector<void*>>*> (popSize, &inputs), outputs, maxThreads, flip_outputs);
+}
 
+template <typename... Types>
+void Population<Types...>::runLockstep (const std::vector<std::vector<std::vector<void*>>>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs, unsigned int maxThreads, bool flip_outputs) {
+	std::vector<const std::vector<std::vector<void*>>*> inputs_ptr;
+	inputs_ptr.reserve (popSize);
+	for (unsigned int i = 0; i < popSize; i++) {
+		inputs_ptr.push_back (&inputs [i]);
 	}
+	RunLockstep (inputs_ptr, outputs, maxThreads, flip_outputs);
 }
 
 template <typename... Types>
-void Population<Types...>::run (const std::vector<std::vector<std::vector<void*>>>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs, unsigned int maxThreads, bool flip_outputs) {
-	if (outputs != nullptr) {
-		// we do care of outputs
+void Population<Types...>::RunLockstep (const std::vector<const std::vector<std::vector<void*>>*>& inputs, std::vector<std::vector<std::vector<void*>>>* outputs, unsigned int maxThreads, bool flip_outputs) {
+	const bool saveOutputs = outputs != nullptr;
 
-		ThreadPool<std::vector<std::vector<void*>>> pool (maxThreads);
+	// group the genomes by species and by length of their sequence of inputs
+	std::map<std::pair<long, size_t>, std::vector<unsigned int>> groups;
+	for (unsigned int i = 0; i < popSize; i++) {
+		const long speciesId = genomes [i]->speciesId >= 0 ? (long) genomes [i]->speciesId : - 1 - (long) i;	// a genome without species is alone
+		groups [std::make_pair (speciesId, inputs [i]->size ())].push_back (i);
+	}
 
-		// the task
-		std::function<std::vector<std::vector<void*>> (Genome<Types...>*, std::vector<std::vector<void*>>&)> func = [&] (Genome<Types...>* genome, std::vector<std::vector<void*>>& inputs_gen) -> std::vector<std::vector<void*>> {
-			if (inputs_gen.size () <= 0) return {};
-			for (const std::vector<void*>& inputs_cur : inputs_gen) {
-				genome->loadInputs (inputs_cur);
-				if (!genome->runNetwork ()) return {};
-				genome->saveOutputs ();
-			}
-			return genome->getSavedOutputs (flip_outputs);
-		};
+	std::vector<const std::vector<unsigned int>*> groups_ptr;
+	groups_ptr.reserve (groups.size ());
+	for (const std::pair<const std::pair<long, size_t>, std::vector<unsigned int>>& group : groups) {
+		groups_ptr.push_back (&group.second);
+	}
 
-		// fill the thread pool
-		std::vector<std::future<std::vector<std::vector<void*>>>> results;
-		results.reserve (popSize);
-		for (unsigned int i = 0; i < popSize; i++) {
-			// add the task to the pool
-			results.emplace_back (pool.enqueue (
-				func,
-				genomes [i].get (),
-				inputs [i]
-			));
+	// a group is a whole task, its cost is the one of its members
+	std::vector<size_t> steps (popSize);
+	for (unsigned int i = 0; i < popSize; i++) {
+		steps [i] = inputs [i]->size ();
+	}
+	const std::vector<double> costs = EstimateCosts (steps);
+	std::vector<double> groupsCosts (groups_ptr.size (), 0.0);
+	for (size_t igroup = 0; igroup < groups_ptr.size (); igroup++) {
+		for (unsigned int i : *groups_ptr [igroup]) {
+			groupsCosts [igroup] += costs [i];
 		}
+	}
 
-		// wait for tasks end
-		for (const std::future<std::vector<std::vector<void*>>>& result : results) {
-			result.wait ();
-		}
+	pool.parallel_for (groupsCosts, [&] (size_t igroup, unsigned int worker) {
+		UNUSED (worker);
+		const std::vector<unsigned int>& group = *groups_ptr [igroup];
+		if (inputs [group [0]]->size () <= 0) return;
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
 
-		// get results
-		outputs->clear ();
-		for (std::future<std::vector<std::vector<void*>>>& result : results) {
-			outputs->push_back (result.get ());
+		std::vector<Genome<Types...>*> group_genomes;
+		group_genomes.reserve (group.size ());
+		for (unsigned int i : group) {
+			group_genomes.push_back (genomes.at (i).get ());
 		}
 
-	} else {
-		// we don't care of outputs
-		UNUSED (outputs);
-
-		ThreadPool<void> pool (maxThreads);
+		LockstepNetwork<Types...> network (group_genomes);
 
-		// the task
-		std::function<void (Genome<Types...>*, std::vector<std::vector<void*>>&)> func = [&] (Genome<Types...>* genome, std::vector<std::vector<void*>>& inputs_gen) -> void {
-			for (const std::vector<void*>& inputs_cur : inputs_gen) {
-				genome->loadInputs (inputs_cur);
-				if (!genome->runNetwork ()) return;
-			}
-		};
+		std::vector<const std::vector<std::vector<void*>>*> inputs_lanes;
+		inputs_lanes.reserve (network.getMembers ().size ());
+		for (size_t k : network.getMembers ()) {
+			inputs_lanes.push_back (inputs [group [k]]);
+		}
+		network.run (inputs_lanes, saveOutputs);
 
-		// fill the thread pool
-		for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-			// add the task to the pool
-			pool.enqueue (
-				func,
-				genome.second.get (),
-				inputs [genome.first]
-			);
+		for (size_t k : network.getFallbacks ()) {
+			group_genomes [k]->RunSequence (*inputs [group [k]], saveOutputs);
 		}
 
-		// will wait for the end of all tasks as ~ThreadPool () will be called
+		// the measured time is shared among the members
+		const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		double work = 0.0;
+		for (Genome<Types...>* genome : group_genomes) {
+			work += (double) (genome->PlanSize () * inputs [group [0]]->size ());
+		}
+		for (Genome<Types...>* genome : group_genomes) {
+			genome->timePerWork = seconds / work;
+		}
+	}, maxThreads);
 
+	if (saveOutputs) {
+		// get results
+		outputs->clear ();
+		for (unsigned int i = 0; i < popSize; i++) {
+			if (inputs [i]->size () <= 0 || genomes [i]->locked) {
+				outputs->push_back ({});
+			} else {
+				outputs->push_back (genomes [i]->getSavedOutputs (flip_outputs));
+			}
+		}
 	}
 }
 
 template <typename... Types>
 void Population<Types...>::run (const unsigned int N_runs, std::vector<std::vector<std::vector<void*>>>* outputs, unsigned int maxThreads, bool flip_outputs) {
+	const std::vector<size_t> steps (popSize, N_runs);
 	if (outputs != nullptr) {
 		// we do care of outputs
-
-		ThreadPool<std::vector<std::vector<void*>>> pool (maxThreads);
-
-		// the task
-		std::function<std::vector<std::vector<void*>> (Genome<Types...>*)> func = [&] (Genome<Types...>* genome) -> std::vector<std::vector<void*>> {
+		outputs->assign (popSize, {});
+		RunGenomes (steps, maxThreads, [&] (Genome<Types...>* genome, size_t i) {
 			for (unsigned int k = 0; k < N_runs; k++) {
 				genome->loadInputs (genome->getOutputs ());
-				if (!genome->runNetwork ()) return {};
+				if (!genome->runNetwork ()) return;
 				genome->saveOutputs ();
 			}
-			return genome->getSavedOutputs (flip_outputs);
-		};
-
-		// fill the thread pool
-		std::vector<std::future<std::vector<std::vector<void*>>>> results;
-		results.reserve (popSize);
-		for (unsigned int i = 0; i < popSize; i++) {
-			// add the task to the pool
-			results.emplace_back (pool.enqueue (
-				func,
-				genomes [i].get ()
-			));
-		}
-
-		// wait for tasks end
-		for (const std::future<std::vector<std::vector<void*>>>& result : results) {
-			result.wait ();
-		}
-
-		// get results
-		outputs->clear ();
-		for (std::future<std::vector<std::vector<void*>>>& result : results) {
-			outputs->push_back (result.get ());
-		}
+			(*outputs) [i] = genome->getSavedOutputs (flip_outputs);
+		});
 
 	} else {
 		// we don't care of outputs
-		UNUSED (outputs);
-
-		ThreadPool<void> pool (maxThreads);
-
-		// the task
-		std::function<void (Genome<Types...>*)> func = [&] (Genome<Types...>* genome) -> void {
+		RunGenomes (steps, maxThreads, [&] (Genome<Types...>* genome, size_t i) {
+			UNUSED (i);
 			for (unsigned int k = 0; k < N_runs; k++) {
 				genome->loadInputs (genome->getOutputs ());
-				if (genome->runNetwork ()) return;
+				if (!genome->runNetwork ()) return;
 			}
-		};
+		});
+	}
+}
 
-		// fill the thread pool
-		for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-			// add the task to the pool
-			pool.enqueue (
-				func,
-				genome.second.get ()
-			);
+template <typename... Types>
+std::vector<double> Population<Types...>::EstimateCosts (const std::vector<size_t>& steps) {
+	// a genome that has never been measured runs at the average measured speed
+	double sumTimePerWork = 0.0;
+	unsigned int nbMeasured = 0;
+	for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
+		if (genome.second->timePerWork > 0.0) {
+			sumTimePerWork += genome.second->timePerWork;
+			nbMeasured ++;
 		}
+	}
+	const double defaultTimePerWork = nbMeasured > 0 ? sumTimePerWork / (double) nbMeasured : 1.0;
 
-		// will wait for the end of all tasks as ~ThreadPool () will be called
-
+	std::vector<double> costs (steps.size ());
+	for (unsigned int i = 0; i < (unsigned int) steps.size (); i++) {
+		const Genome<Types...>* genome = genomes.at (i).get ();
+		costs [i] = (double) (genome->PlanSize () * std::max (steps [i], (size_t) 1)) * (genome->timePerWork > 0.0 ? genome->timePerWork : defaultTimePerWork);
 	}
+	return costs;
+}
 
+template <typename... Types>
+template <typename Func>
+void Population<Types...>::RunGenomes (const std::vector<size_t>& steps, unsigned int maxThreads, Func&& func) {
+	// the heaviest genomes start first, and their time is measured to refine the next estimations
+	pool.parallel_for (EstimateCosts (steps), [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		Genome<Types...>* genome = genomes.at ((unsigned int) i).get ();
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		func (genome, i);
+		const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+		genome->timePerWork = seconds / (double) (genome->PlanSize () * std::max (steps [i], (size_t) 1));
+	}, maxThreads);
 }
 
 template <typename... Types>
@@ -800,18 +1006,40 @@ void Population<Types...>::resetMemory (unsigned int genome_id, bool resetMemory
 
 template <typename... Types>
 void Population<Types...>::runNetworks (unsigned int maxThreads) {
-	ThreadPool<void> pool (maxThreads);
+	RunGenomes (std::vector<size_t> (popSize, 1), maxThreads, [&] (Genome<Types...>* genome, size_t i) {
+		UNUSED (i);
+		genome->runNetwork ();
+	});
+}
 
-	for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-		// add the task to the pool
-		pool.enqueue (
-			[&] () -> void {
-				genome.second->runNetwork ();
-			}
-		);
-	}
+template <typename... Types>
+void Population<Types...>::evaluate (const std::function<double (Genome<Types...>&, evalContext_t&)>& evaluationFn, unsigned int maxThreads, const std::function<std::shared_ptr<void> ()>& environmentFactory) {
+	std::vector<evalContext_t> contexts (pool.getNumThreads ());	// one per thread
+	for (unsigned int worker = 0; worker < (unsigned int) contexts.size (); worker++) {
+		contexts [worker].worker = worker;
+	}
+
+	// the results are only set once every genome has been evaluated, so that an exception leaves the population as it was
+	std::vector<double> fitnesses (popSize);
+	std::vector<double> timesPerWork (popSize);
+	pool.parallel_for (EstimateCosts (std::vector<size_t> (popSize, 1)), [&] (size_t i, unsigned int worker) {
+		Genome<Types...>* genome = genomes.at ((unsigned int) i).get ();
+		evalContext_t& context = contexts [worker];
+		if (environmentFactory && !context.environment) {
+			context.environment = environmentFactory ();
+		}
+		context.genomeId = (unsigned int) i;
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+		fitnesses [i] = evaluationFn (*genome, context);
+		timesPerWork [i] = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count () / (double) genome->PlanSize ();
+	}, maxThreads);
 
-	// wait for the end of all tasks as ~ThreadPool () is called
+	for (unsigned int i = 0; i < popSize; i++) {
+		Genome<Types...>* genome = genomes.at (i).get ();
+		genome->timePerWork = timesPerWork [i];
+		genome->setFitness (fitnesses [i]);
+	}
 }
 
 template <typename... Types>
@@ -849,92 +1077,131 @@ void Population<Types...>::setFitness (double fitness, unsigned int genome_id) {
 template <typename... Types>
 void Population<Types...>::speciate (unsigned int target, unsigned int maxIterationsReachTarget, double stepThresh, double a, double b, double c, double speciesSizeEvolutionMax, double speciesSizeEvolutionMin, double speciesSizeLimit) {
 	logger->info ("Speciation");
+	RandomScope random (Stream (SPECIATION_STREAM));
+
+	// the genomes' genes are sorted by innovation ID once, before being compared to the species
+	pool.parallel_for (genomes.size (), [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		genomes.at ((unsigned int) i)->UpdateGenes ();
+	});
+
+	const unsigned int nbGenomes = (unsigned int) genomes.size ();
+	const unsigned int species_len = (unsigned int) species.size ();
+	speciationCache_t& cache = speciationCache;
+	// the rows are computed when empty: they are emptied rather than freed
+	for (std::vector<double>& row : cache.distances) {
+		row.clear ();
+	}
+	for (std::vector<double>& row : cache.foundersDistances) {
+		row.clear ();
+	}
+	cache.distances.resize (nbGenomes);
+	cache.foundersDistances.resize (nbGenomes);
+	cache.assignment.assign (nbGenomes, -1);
+	if (speciationMode == LSH_SPECIATION) {
+		HashGenes (cache);
+	}
+	if (IsIndexed ()) {
+		IndexSpecies (cache);
+		cache.searchedBounds.assign (nbGenomes, -1.0);
+	}
+
+	// the distance to the previous species first, which is enough for the genomes staying in it
+	cache.previousDistances.assign (nbGenomes, -1.0);
+	pool.parallel_for (nbGenomes, [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		const int previous = genomes.at ((unsigned int) i)->speciesId;
+		if (previous >= 0 && previous < (int) species_len && !species [previous].isDead) {
+			cache.previousDistances [i] = species [previous].distanceWith (genomes.at ((unsigned int) i), a, b, c);
+		}
+	});
 
-	std::vector<Species<Types...>> tmpspecies;
-	unsigned int nbSpeciesAlive = 0;
+	// the number of species decreases as the threshold increases: the number of steps giving the target is searched by galloping then by bisection,
+	// within the steps the threshold could have been adjusted by (thresholds far from the current one, founding many species, are only tried if needed)
 	unsigned int ite = 0;
-
-	std::vector<std::vector<double>> distances (popSize, std::vector<double> (species.size (), -1.0));
-
-	while (ite < maxIterationsReachTarget && nbSpeciesAlive != target) {
-
-		// init tmpspecies
-		tmpspecies.clear ();
-		tmpspecies = species;
-		const unsigned int species_len = (unsigned int) species.size ();
-		nbSpeciesAlive = 0;
-
-		// reset tmpspecies
-		for (Species<Types...>& tmpspe : tmpspecies) {
-			if (!tmpspe.isDead) {	// if the species is still alive
-				tmpspe.members.clear ();
+	int lastSteps = 0;
+	unsigned int lastAlive = 0;
+	auto tryThresh = [&] (int steps) {
+		ite++;
+		lastSteps = steps;
+		lastAlive = AssignSpecies (cache, speciationThresh + steps * stepThresh, a, b, c);
+		return lastAlive;
+	};
+	int steps = 0;
+	int outOfReach = 0;
+	unsigned int nbSpeciesAlive = tryThresh (0);
+	if (nbSpeciesAlive != target) {
+		const int dir = nbSpeciesAlive < target ? -1 : 1;	// too few species: the threshold has to decrease
+		auto reached = [&] (unsigned int nbAlive) {
+			return dir < 0 ? nbAlive >= target : nbAlive <= target;
+		};
+		const int maxSteps = maxIterationsReachTarget > 1 ? (int) maxIterationsReachTarget - 1 : 0;
+		int lo = 0;	// a number of steps not reaching the target
+		unsigned int nbAliveLo = nbSpeciesAlive;
+		int hi = 0;	// a number of steps reaching the target, once found
+		unsigned int nbAliveHi = nbSpeciesAlive;
+		bool found = false;
+		for (int probe = 1; !found && lo < maxSteps; probe *= 2) {
+			hi = std::min (probe, maxSteps);
+			nbAliveHi = tryThresh (dir * hi);
+			if (reached (nbAliveHi)) {
+				found = true;
+			} else {
+				lo = hi;
+				nbAliveLo = nbAliveHi;
 			}
 		}
-
-		// speciation
-		for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-			size_t itmpspeciesBest;
-			double dstBest = std::numeric_limits<double>::max ();
-			if (tmpspecies.size () > 0) {	// if there is at least one species
-
-				// we search for the closest species
-				double dst;
-				for (Species<Types...>& tmpspe : tmpspecies) {
-					if (tmpspe.id < species_len && distances [genome.first][tmpspe.id] >= 0) {
-						//reuse of previously saved distance
-						dst = distances [genome.first][tmpspe.id];
-					} else {
-						dst = tmpspe.distanceWith (genome.second, a, b, c);
-						if (tmpspe.id < species_len) {
-							// this species has not been recently created and might be reused in a near future
-							distances [genome.first][tmpspe.id] = dst;
-						}
-					}
-					if (!tmpspe.isDead && dst <= dstBest) {
-						// we found a closer one
-						itmpspeciesBest = tmpspe.id;
-						dstBest = dst;
-					}
+		if (!found) {
+			// the target is out of reach: the furthest threshold is used, and the next speciation will start one step further
+			steps = dir * lo;
+			outOfReach = dir;
+		} else {
+			while (hi - lo > 1) {
+				const int mid = (lo + hi) / 2;
+				const unsigned int nbAliveMid = tryThresh (dir * mid);
+				if (reached (nbAliveMid)) {
+					hi = mid;
+					nbAliveHi = nbAliveMid;
+				} else {
+					lo = mid;
+					nbAliveLo = nbAliveMid;
 				}
-
 			}
-			if (dstBest >= speciationThresh) {
-				// the closest species is too far or there is no species: we create a new one
-				itmpspeciesBest = tmpspecies.size ();
-				tmpspecies.push_back (Species<Types...> ((unsigned int) itmpspeciesBest, genome.second->connections, dstType));
+			// hi is the first number of steps reaching the target: it is used unless lo gets closer to the target
+			if (std::abs ((int) nbAliveHi - (int) target) <= std::abs ((int) nbAliveLo - (int) target)) {
+				steps = dir * hi;
+			} else {
+				steps = dir * lo;
 			}
-
-			tmpspecies [itmpspeciesBest].members.push_back (genome.first);
-			genome.second->speciesId = tmpspecies [itmpspeciesBest].id;
 		}
+		// the cache holds the assignment of the last threshold tried
+		nbSpeciesAlive = steps == lastSteps ? lastAlive : tryThresh (steps);
+	}
+	speciationThresh += (steps + outOfReach) * stepThresh;
+	if (speciationMode == LSH_SPECIATION) {
+		MeasureRecall (cache, species_len, a, b, c);
+	}
 
-		// check how many species are still alive
-		for (Species<Types...>& tmpspe : tmpspecies) {
-			if (tmpspe.members.size () <= 0) {
-				// the species has no member, the species is dead
-				tmpspe.isDead = true;
-			}
-			if (!tmpspe.isDead) {	// if the species is still alive
-				nbSpeciesAlive ++;
-			}
+	// apply the assignment
+	for (Species<Types...>& spe : species) {
+		if (!spe.isDead) {	// if the species is still alive
+			spe.members.clear ();
 		}
-
-		// update speciationThresh
-		if (nbSpeciesAlive < target) {
-			speciationThresh -= stepThresh;
-		} else {
-			if (nbSpeciesAlive > target) {
-				speciationThresh += stepThresh;
-			}
+	}
+	for (unsigned int founder : cache.founders) {
+		species.push_back (Species<Types...> ((unsigned int) species.size (), genomes.at (founder)->connections, dstType));
+	}
+	for (unsigned int genomeId = 0; genomeId < nbGenomes; genomeId++) {
+		species [cache.assignment [genomeId]].members.push_back (genomeId);
+		genomes.at (genomeId)->speciesId = cache.assignment [genomeId];
+	}
+	for (Species<Types...>& spe : species) {
+		if (spe.members.size () <= 0) {
+			// the species has no member, the species is dead
+			spe.isDead = true;
 		}
-
-		ite++;
 	}
 
-	// Set tmpspecies as species
-	species.clear ();
-	species = tmpspecies;
-
 	logger->trace ("speciation result in {0} alive species in {1} iteration(s)", nbSpeciesAlive, ite);
 	if ((float) nbSpeciesAlive > (float) target * 1.3f || (float) nbSpeciesAlive < (float) target * 0.7f) {
 		logger->warn ("There is a huge difference between target ({0}) and the current number of species ({1})", target, nbSpeciesAlive);
@@ -954,6 +1221,7 @@ void Population<Types...>::speciate (unsigned int target, unsigned int maxIterat
 				}
 			}
 			spe.connections = genomes [leaderId]->connections;	// species leader is the more fit genome
+			spe.genes = genomes [leaderId]->genes;
 		}
 	}
 
@@ -961,6 +1229,281 @@ void Population<Types...>::speciate (unsigned int target, unsigned int maxIterat
 	UpdateFitnesses (speciesSizeEvolutionMax, speciesSizeEvolutionMin, speciesSizeLimit, target);
 }
 
+template <typename... Types>
+void Population<Types...>::HashGenes (speciationCache_t& cache) {
+	const unsigned int nbGenomes = (unsigned int) genomes.size ();
+	const unsigned int nbBands = minHash.getNbBands ();
+
+	// the band keys of the genomes, then of the species' leaders
+	cache.genomesKeys.resize ((size_t) nbGenomes * nbBands);
+	pool.parallel_for (nbGenomes, [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		minHash.bandKeys (genomes.at ((unsigned int) i)->genes, &cache.genomesKeys [i * nbBands]);
+	});
+	std::vector<uint64_t> speciesKeys (species.size () * nbBands);
+	pool.parallel_for (species.size (), [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		if (!species [i].isDead) {
+			minHash.bandKeys (species [i].genes, &speciesKeys [i * nbBands]);
+		}
+	});
+
+	// the buckets, filled by ID
+	cache.speciesBuckets.assign (nbBands, std::unordered_map<uint64_t, std::vector<unsigned int>> ());
+	cache.genomesBuckets.assign (nbBands, std::unordered_map<uint64_t, std::vector<unsigned int>> ());
+	for (unsigned int band = 0; band < nbBands; band++) {
+		for (unsigned int speciesId = 0; speciesId < (unsigned int) species.size (); speciesId++) {
+			if (!species [speciesId].isDead) {
+				cache.speciesBuckets [band][speciesKeys [(size_t) speciesId * nbBands + band]].push_back (speciesId);
+			}
+		}
+		for (unsigned int genomeId = 0; genomeId < nbGenomes; genomeId++) {
+			cache.genomesBuckets [band][cache.genomesKeys [(size_t) genomeId * nbBands + band]].push_back (genomeId);
+		}
+	}
+
+	// the shortlisted species of each genome
+	cache.shortlists.resize (nbGenomes);
+	pool.parallel_for (nbGenomes, [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		cache.shortlists [i] = Shortlist (cache, cache.speciesBuckets, (unsigned int) i);
+	});
+}
+
+template <typename... Types>
+void Population<Types...>::IndexSpecies (speciationCache_t& cache) {
+	// the euclidian distance is not a metric between genomes holding several connections with the same innovation id: the leaders are indexed
+	// by the square root of a lower bound of it, which is one
+	std::vector<unsigned int> alive;
+	for (unsigned int speciesId = 0; speciesId < (unsigned int) species.size (); speciesId++) {
+		if (!species [speciesId].isDead) {
+			alive.push_back (speciesId);
+		}
+	}
+	cache.speciesIndex.build (alive, [&] (unsigned int speciesId1, unsigned int speciesId2) {
+		return std::sqrt (Species<Types...>::EuclidianLowerBound (species [speciesId1].genes, species [speciesId2].genes));
+	});
+}
+
+template <typename... Types>
+std::vector<unsigned int> Population<Types...>::Shortlist (const speciationCache_t& cache, const std::vector<std::unordered_map<uint64_t, std::vector<unsigned int>>>& buckets, unsigned int genomeId) const {
+	// everything sharing at least one band's bucket with the genome, by ID
+	const unsigned int nbBands = minHash.getNbBands ();
+	std::vector<unsigned int> result;
+	for (unsigned int band = 0; band < nbBands; band++) {
+		typename std::unordered_map<uint64_t, std::vector<unsigned int>>::const_iterator bucket = buckets [band].find (cache.genomesKeys [(size_t) genomeId * nbBands + band]);
+		if (bucket != buckets [band].end ()) {
+			result.insert (result.end (), bucket->second.begin (), bucket->second.end ());
+		}
+	}
+	std::sort (result.begin (), result.end ());
+	result.erase (std::unique (result.begin (), result.end ()), result.end ());
+	return result;
+}
+
+template <typename... Types>
+unsigned int Population<Types...>::AssignSpecies (speciationCache_t& cache, double thresh, double a, double b, double c) {
+	const unsigned int nbGenomes = (unsigned int) genomes.size ();
+	const unsigned int species_len = (unsigned int) species.size ();
+	auto staysInPrevious = [&] (unsigned int genomeId) {
+		return cache.previousDistances [genomeId] >= 0 && cache.previousDistances [genomeId] < thresh;
+	};
+
+	// the distances to every species of the genomes leaving their previous species, if they are not known yet
+	// (with the index, to the species which could be closer than the threshold, if they have not been searched under it yet)
+	std::vector<unsigned int>& toCompare = cache.toCompare;
+	std::vector<unsigned int>& toSearch = cache.toSearch;
+	toCompare.clear ();
+	toSearch.clear ();
+	for (unsigned int genomeId = 0; genomeId < nbGenomes; genomeId++) {
+		if (staysInPrevious (genomeId)) {
+			continue;
+		}
+		if (IsIndexed ()) {
+			if (cache.distances [genomeId].empty () || cache.searchedBounds [genomeId] < thresh) {
+				toSearch.push_back (genomeId);
+			}
+		} else if (cache.distances [genomeId].empty ()) {
+			toCompare.push_back (genomeId);
+		}
+		if (cache.distances [genomeId].empty ()) {
+			cache.distances [genomeId].assign (species_len, -1.0);
+		}
+	}
+	std::vector<std::pair<unsigned int, unsigned int>>& pairs = cache.pairs;	// (genome, species)
+	pairs.clear ();
+	for (unsigned int genomeId : toCompare) {
+		if (speciationMode == LSH_SPECIATION && cache.shortlists [genomeId].size () > 0) {
+			// only the shortlisted species
+			for (unsigned int speciesId : cache.shortlists [genomeId]) {
+				pairs.push_back (std::make_pair (genomeId, speciesId));
+			}
+		} else {
+			// every species, including for a genome sharing no band with any species' leader
+			for (unsigned int speciesId = 0; speciesId < species_len; speciesId++) {
+				if (!species [speciesId].isDead) {
+					pairs.push_back (std::make_pair (genomeId, speciesId));
+				}
+			}
+		}
+	}
+	// each pair is a task: the pass is balanced even if only a few genomes have to be compared
+	pool.parallel_for (pairs.size (), [&] (size_t k, unsigned int worker) {
+		UNUSED (worker);
+		cache.distances [pairs [k].first][pairs [k].second] = species [pairs [k].second].distanceWith (genomes.at (pairs [k].first), a, b, c);
+	});
+	pool.parallel_for (toSearch.size (), [&] (size_t k, unsigned int worker) {
+		UNUSED (worker);
+		// only the species which could be closer than the threshold, or than the closest one known, are compared: every species at least as close
+		// as the closest one gets its distance, so that the ties are broken as with every species
+		const unsigned int genomeId = toSearch [k];
+		std::vector<double>& row = cache.distances [genomeId];
+		const int previous = genomes.at (genomeId)->speciesId;
+		if (cache.previousDistances [genomeId] >= 0) {
+			row [previous] = cache.previousDistances [genomeId];
+		}
+		double bound = thresh;
+		for (double dst : row) {
+			if (dst >= 0 && dst < bound) {
+				bound = dst;
+			}
+		}
+		cache.speciesIndex.nearest ([&] (unsigned int speciesId) {
+			if (row [speciesId] < 0) {
+				row [speciesId] = species [speciesId].distanceWith (genomes.at (genomeId), a, b, c);
+			}
+			return std::make_pair (std::sqrt (Species<Types...>::EuclidianLowerBound (genomes.at (genomeId)->genes, species [speciesId].genes)), std::sqrt (row [speciesId]));
+		}, std::sqrt (bound));
+
+		// the closest species is known whatever the threshold if one is under it, otherwise it has to be searched again for a higher threshold
+		bool found = false;
+		for (double dst : row) {
+			found = found || (dst >= 0 && dst <= thresh);
+		}
+		cache.searchedBounds [genomeId] = found ? std::numeric_limits<double>::infinity () : thresh;
+	});
+
+	// the genomes are assigned by ID
+	std::vector<unsigned int> nbMembers (species_len, 0);
+	cache.founders.clear ();
+	for (unsigned int genomeId = 0; genomeId < nbGenomes; genomeId++) {
+		if (staysInPrevious (genomeId)) {
+			cache.assignment [genomeId] = genomes.at (genomeId)->speciesId;
+			nbMembers [cache.assignment [genomeId]] ++;
+			continue;
+		}
+
+		// we search for the closest species
+		int best = -1;
+		double dstBest = std::numeric_limits<double>::max ();
+		for (unsigned int speciesId = 0; speciesId < species_len; speciesId++) {
+			if (!species [speciesId].isDead && cache.distances [genomeId][speciesId] >= 0 && cache.distances [genomeId][speciesId] <= dstBest) {
+				best = (int) speciesId;
+				dstBest = cache.distances [genomeId][speciesId];
+			}
+		}
+		for (unsigned int k = 0; k < (unsigned int) cache.founders.size (); k++) {
+			const double dst = cache.foundersDistances [cache.founders [k]][genomeId];
+			if (dst >= 0 && dst <= dstBest) {
+				best = (int) (species_len + k);
+				dstBest = dst;
+			}
+		}
+
+		if (dstBest >= thresh) {
+			// the closest species is too far or there is no species: the genome founds a new one
+			best = (int) (species_len + cache.founders.size ());
+			cache.founders.push_back (genomeId);
+
+			// its distances to the next genomes which might be compared to it, if they are not known yet
+			std::vector<double>& founderDistances = cache.foundersDistances [genomeId];
+			if (founderDistances.empty ()) {
+				founderDistances.assign (nbGenomes, -1.0);
+			}
+			std::vector<unsigned int> toCompareFounder;
+			if (speciationMode == LSH_SPECIATION) {
+				// only the genomes sharing a band with the founder, and the ones compared to every species
+				const std::vector<unsigned int> shortlist = Shortlist (cache, cache.genomesBuckets, genomeId);
+				std::vector<bool> shortlisted (nbGenomes, false);
+				for (unsigned int nextId : shortlist) {
+					shortlisted [nextId] = true;
+				}
+				for (unsigned int nextId = genomeId + 1; nextId < nbGenomes; nextId++) {
+					if ((shortlisted [nextId] || cache.shortlists [nextId].empty ()) && !staysInPrevious (nextId) && founderDistances [nextId] < 0) {
+						toCompareFounder.push_back (nextId);
+					}
+				}
+			} else {
+				for (unsigned int nextId = genomeId + 1; nextId < nbGenomes; nextId++) {
+					if (!staysInPrevious (nextId) && founderDistances [nextId] < 0) {
+						toCompareFounder.push_back (nextId);
+					}
+				}
+			}
+			pool.parallel_for (toCompareFounder.size (), [&] (size_t k, unsigned int worker) {
+				UNUSED (worker);
+				founderDistances [toCompareFounder [k]] = Species<Types...>::Distance (dstType, genomes.at (toCompareFounder [k])->genes, genomes.at (genomeId)->genes, a, b, c);
+			});
+		} else if (best < (int) species_len) {
+			nbMembers [best] ++;
+		}
+		cache.assignment [genomeId] = best;
+	}
+
+	unsigned int nbSpeciesAlive = (unsigned int) cache.founders.size ();
+	for (unsigned int nb : nbMembers) {
+		if (nb > 0) {
+			nbSpeciesAlive ++;
+		}
+	}
+	return nbSpeciesAlive;
+}
+
+template <typename... Types>
+void Population<Types...>::MeasureRecall (const speciationCache_t& cache, unsigned int species_len, double a, double b, double c) {
+	// samples among the genomes which have been compared to the shortlisted species, evenly spread
+	std::vector<unsigned int> compared;
+	for (unsigned int genomeId = 0; genomeId < (unsigned int) genomes.size (); genomeId++) {
+		if (!cache.distances [genomeId].empty ()) {
+			compared.push_back (genomeId);
+		}
+	}
+	std::vector<unsigned int> samples;
+	for (size_t k = 0; k < (size_t) nbRecallSamples && k < compared.size (); k++) {
+		samples.push_back (compared [k * compared.size () / std::min ((size_t) nbRecallSamples, compared.size ())]);
+	}
+	if (samples.size () <= 0) {
+		speciationRecall = -1.0;
+		return;
+	}
+
+	// their closest species, among all of them
+	std::vector<int> closest (samples.size (), -1);
+	pool.parallel_for (samples.size (), [&] (size_t k, unsigned int worker) {
+		UNUSED (worker);
+		double dstBest = std::numeric_limits<double>::max ();
+		for (unsigned int speciesId = 0; speciesId < species_len; speciesId++) {
+			if (!species [speciesId].isDead) {
+				const double dst = species [speciesId].distanceWith (genomes.at (samples [k]), a, b, c);
+				if (dst <= dstBest) {
+					closest [k] = (int) speciesId;
+					dstBest = dst;
+				}
+			}
+		}
+	});
+
+	unsigned int nbFound = 0;
+	for (size_t k = 0; k < samples.size (); k++) {
+		if (closest [k] < 0 || cache.distances [samples [k]][closest [k]] >= 0) {
+			// the closest species was shortlisted
+			nbFound ++;
+		}
+	}
+	speciationRecall = (double) nbFound / (double) samples.size ();
+	logger->trace ("LSH speciation recall: {0} ({1} genomes sampled)", speciationRecall, samples.size ());
+}
+
 template <typename... Types>
 std::unordered_map <unsigned int, Connection> Population<Types...>::GetWeightedCentroid (unsigned int speciesId) {
 	std::unordered_map <unsigned int, Connection> result;
@@ -1091,19 +1634,52 @@ void Population<Types...>::UpdateFitnesses (double speciesSizeEvolutionMax, doub
 template <typename... Types>
 void Population<Types...>::crossover (bool elitism, double crossover_rate) {
 	logger->info ("Crossover");
-	std::unordered_map<unsigned int, std::unique_ptr<Genome<Types...>>> newGenomes;
-	newGenomes.reserve (popSize);
+	Reproduce (elitism, crossover_rate, [] (Genome<Types...>& genome) {
+		// the genome is kept for the new generation (there is no crossover which emphasize mutation's effect eg exploration)
+		UNUSED (genome);
+	});
+}
 
-	unsigned int genomeId = 0;
+template <typename... Types>
+unsigned int Population<Types...>::SelectParent (unsigned int iSpe) const {
+	// chooses a genome of the species pseudo-randomly (considering fitness), from the selection built for the current generation
+	return species [iSpe].members [reproductionCache.selectors [iSpe].select ()];
+}
 
-	if (elitism) {	// elitism mode on = we conserve during generations the more fit genome
-			newGenomes.insert (std::make_pair (genomeId, genomes [fittergenome_id]->clone ()));
-		newGenomes [genomeId]->id = genomeId;
-		genomeId++;
+template <typename... Types>
+template <typename Func>
+void Population<Types...>::Reproduce (bool elitism, double crossover_rate, Func&& mutateOffspring) {
+	reproductionCache_t& cache = reproductionCache;
+
+	// elitism mode on = we conserve during generations the more fit genomes, as the first ones
+	std::vector<unsigned int>& elites = cache.elites;
+	elites.clear ();
+	if (elitism && nbElites > 0) {
+		if (fittergenome_id < 0) {
+			logger->warn ("Calling Population<Types...>::Reproduce cannot determine which are the more fit genomes: in order to know it, call Population<Types...>::speciate first. No genome is kept.");
+		} else {
+			// a locked genome cannot be given a fitness anymore: it is never kept
+			const bool fitterKept = !genomes [fittergenome_id]->locked;
+			if (fitterKept) {
+				elites.push_back ((unsigned int) fittergenome_id);
+			}
+			for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
+				if (genome.first != (unsigned int) fittergenome_id && !genome.second->locked) {
+					elites.push_back (genome.first);
+				}
+			}
+			const size_t N_elites = std::min ((size_t) nbElites, elites.size ());
+			std::partial_sort (elites.begin () + (fitterKept ? 1 : 0), elites.begin () + (std::ptrdiff_t) N_elites, elites.end (), [&] (unsigned int id1, unsigned int id2) {
+				return genomes [id1]->fitness > genomes [id2]->fitness || (genomes [id1]->fitness == genomes [id2]->fitness && id1 < id2);
+			});
+			elites.resize (N_elites);
+		}
 	}
+	const unsigned int firstOffspring = (unsigned int) elites.size ();
 
 	// scale the number of offsprings to the exact population's size
-	std::vector<unsigned int> species_alive;
+	std::vector<unsigned int>& species_alive = cache.speciesAlive;
+	species_alive.clear ();
 	int N_offsprings = 0; 
 	for (const Species<Types...>& spe : species) {
 		if (!spe.isDead) {
@@ -1119,225 +1695,119 @@ void Population<Types...>::crossover (bool elitism, double crossover_rate) {
 			species_alive.push_back(spe.id);
 		}
 	}
-	for (int k = 0; k < (int) popSize - N_offsprings - (int) elitism; k++) {
+	for (int k = 0; k < (int) popSize - N_offsprings - (int) firstOffspring; k++) {
 		// some offsprings are missing, let's help the weakest species
 		std::sort(species_alive.begin(), species_alive.end(), [&](const unsigned int& a, const unsigned int& b) {return species [a].allowedOffspring < species [b].allowedOffspring;});
 		species [species_alive [0]].allowedOffspring += 1;
 	}
-	for (int k = 0; k < (int) elitism + N_offsprings - (int) popSize; k++) {
+	for (int k = 0; k < (int) firstOffspring + N_offsprings - (int) popSize; k++) {
 		// there is too meny offsprings, let's weaken the strongest species
 		std::sort(species_alive.begin(), species_alive.end(), [&](const unsigned int& a, const unsigned int& b) {return species [a].allowedOffspring > species [b].allowedOffspring;});
 		species [species_alive [0]].allowedOffspring -= 1;
 	}
 
-	// process offsprings
+	// the species of each offspring, the offsprings being built in parallel
+	std::vector<unsigned int>& offspringsSpecies = cache.offspringsSpecies;
+	offspringsSpecies.clear ();
 	for (const Species<Types...>& spe : species) {
 		if (!spe.isDead) {
 			for (int k = 0; k < spe.allowedOffspring; k++) {
-
-				// choose pseudo-randomly a first parent
-				unsigned int iParent1 = SelectParent (spe.id);
-
-				if (Random_Double (0.0, 1.0, true, false) < crossover_rate && spe.members.size () > 1) {
-					// choose pseudo-randomly a second parent
-					unsigned int iParent2 = SelectParent (spe.id);	// TODO might be the same parent as iParent1: is that an issue?
-
-					// clone the more fit
-					unsigned int iMainParent;
-					unsigned int iSecondParent;
-					if (genomes [iParent1]->fitness > genomes [iParent2]->fitness) {
-						iMainParent = iParent1;
-						iSecondParent = iParent2;
-					} else {
-						iMainParent = iParent2;
-						iSecondParent = iParent1;
-					}
-
-					newGenomes.insert (std::make_pair (genomeId, genomes [iMainParent]->clone ()));
-					std::unique_ptr<Genome<Types...>>& genome = newGenomes [genomeId];
-					genome->id = genomeId;
-					genomeId++;
-
-					// connections shared by both of the parents must be randomly wheighted
-					for (const std::pair<const unsigned int, Connection>& connMainParent : genomes [iMainParent]->connections) {
-						for (const std::pair<const unsigned int, Connection>& connSecondParent : genomes [iSecondParent]->connections) {
-							if (connMainParent.second.innovId == connSecondParent.second.innovId) {
-								if (Random_Double (0.0, 1.0, true, false) < 0.5) {	// 50 % of chance for each parent, newGenome already have the wheight of MainParent
-									genome->connections [connMainParent.second.id].weight = connSecondParent.second.weight;
-								}
-							}
-						}
-					}
-				} else {
-					// the genome is kept for the new generation (there is no crossover which emphasize mutation's effect eg exploration)
-					newGenomes.insert (std::make_pair (genomeId, genomes [iParent1]->clone ()));
-					newGenomes [genomeId]->id = genomeId;
-					genomeId++;
-				}
+				offspringsSpecies.push_back (spe.id);
 			}
 		}
 	}
 
-	// replace the current genomes by the new ones
-	genomes.clear ();
-	genomes = std::move (newGenomes);
-
-	// reset species members
-	for (Species<Types...>& spe : species) {
-		spe.members.clear ();
-		spe.isDead = true;
-	}
-	for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-		if (genome.second->speciesId > -1) {
-			species [genome.second->speciesId].members.push_back (genome.first);
-			species [genome.second->speciesId].isDead = false;	// empty species will stay to isDead = true
+	// the selection of the parents is built once for each species giving offsprings, then sampled by every thread
+	cache.selectors.resize (species.size ());
+	for (const Species<Types...>& spe : species) {
+		if (!spe.isDead && spe.allowedOffspring > 0) {
+			cache.fitnesses.clear ();
+			for (unsigned int genomeID : spe.members) {
+				cache.fitnesses.push_back (genomes [genomeID]->fitness);
+			}
+			cache.selectors [spe.id].build (cache.fitnesses, selectionMode, tournamentSize, truncationRate);
 		}
 	}
 
-	fittergenome_id = -1;	// avoid a missuse of fittergenome_id
-
-	generation ++;
-}
-
-template <typename... Types>
-int Population<Types...>::SelectParent (unsigned int iSpe) {
-	/* Chooses player from the population to return randomly(considering fitness).
-	This works by randomly choosing a value between 0 and the sum of all the fitnesses then go through all the genomes
-	and add their fitness to a running sum and if that sum is greater than the random value generated,
-	that genome is chosen since players with a higher fitness function add more to the running sum then they have a higher chance of being chosen */
-
-	if (Eq_Double (species [iSpe].sumFitness, 0.0)) {
-		// everyone as a null fitness: we return a random genome
-		return species [iSpe].members [
-			Random_UInt (0, (unsigned int) species [iSpe].members.size () - 1)
-		];
-	}
-
-	double randThresh = Random_Double (0.0, species [iSpe].sumFitness, true, false);
-	double runningSum = 0.0;
-	for (unsigned int genomeID : species [iSpe].members) {
-		runningSum += genomes [genomeID]->fitness;
-		if (runningSum > randThresh) {
-			return genomeID;
+	// each offspring overwrites a genome of the previous generation if there is one left, rather than a new one
+	std::vector<std::unique_ptr<Genome<Types...>>>& offsprings = cache.offsprings;
+	offsprings.resize (firstOffspring + offspringsSpecies.size ());
+	for (size_t i = firstOffspring; i < offsprings.size (); i++) {
+		if (!cache.retiredGenomes.empty ()) {
+			offsprings [i] = std::move (cache.retiredGenomes.back ());
+			cache.retiredGenomes.pop_back ();
 		}
 	}
-	return -1;	// impossible
-}
 
-template <typename... Types>
-void Population<Types...>::mutate (const mutationParams_t& params) {
-	logger->info ("Mutations");
+	// the parents are then cloned and crossed without being written
 	for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-		genome.second->mutate (&conn_innov, &node_innov, params);
+		genome.second->typed.storeInputs ();
+		genome.second->UpdateGenes ();
 	}
-}
+	const unsigned int firstConnId = conn_innov.N_connectionId;
+	const unsigned int firstNodeId = node_innov.N_nodeId;
 
-template <typename... Types>
-void Population<Types...>::mutate (const std::function<mutationParams_t (double)>& paramsMap) {
-	logger->info ("Mutations");
-	for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-		genome.second->mutate (&conn_innov, &node_innov, paramsMap (genome.second->fitness));
-	}
-}
+	// process offsprings, each one drawing from its own random stream
+	pool.parallel_for (offspringsSpecies.size (), [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		RandomScope random (Stream (REPRODUCTION_STREAM, firstOffspring + (unsigned int) i));
+		const Species<Types...>& spe = species [offspringsSpecies [i]];
 
+		// choose pseudo-randomly a first parent
+		unsigned int iParent1 = SelectParent (spe.id);
 
-template <typename... Types>
-void Population<Types...>::buildNextGen (const mutationParams_t& mutationParams, bool elitism, double crossover_rate)  {
-	logger->info ("Build the new generation");
-	std::unordered_map<unsigned int, std::unique_ptr<Genome<Types...>>> newGenomes;
-	newGenomes.reserve (popSize);
+		if (Random_Double (0.0, 1.0, true, false) < crossover_rate && spe.members.size () > 1) {
+			// New genome comes from a crossover
 
-	unsigned int genomeId = 0;
+			// choose pseudo-randomly a second parent
+			unsigned int iParent2 = SelectParent (spe.id);	// TODO might be the same parent as iParent1: is that an issue?
 
-	if (elitism) {	// elitism mode on = we conserve during generations the more fit genome
-		newGenomes.insert (std::make_pair (genomeId, genomes [fittergenome_id]->clone ()));
-		newGenomes [genomeId]->id = genomeId;
-		genomeId++;
-	}
+			// clone the more fit
+			unsigned int iMainParent;
+			unsigned int iSecondParent;
+			if (genomes.at (iParent1)->fitness > genomes.at (iParent2)->fitness) {
+				iMainParent = iParent1;
+				iSecondParent = iParent2;
+			} else {
+				iMainParent = iParent2;
+				iSecondParent = iParent1;
+			}
 
-	// scale the number of offsprings to the exact population's size
-	std::vector<unsigned int> species_alive;
-	int N_offsprings = 0; 
-	for (const Species<Types...>& spe : species) {
-		if (!spe.isDead) {
-			N_offsprings += spe.allowedOffspring;
-			species_alive.push_back(spe.id);
+			std::unique_ptr<Genome<Types...>>& genome = offsprings [firstOffspring + i];
+			genome = genomes.at (iMainParent)->Clone (std::move (genome));
+
+			// connections shared by both of the parents must be randomly wheighted
+			genome->InheritWeights (genomes.at (iSecondParent)->genes);
+		} else {
+			std::unique_ptr<Genome<Types...>>& genome = offsprings [firstOffspring + i];
+			genome = genomes.at (iParent1)->Clone (std::move (genome));
+			mutateOffspring (*genome);
 		}
-	}
-	if (species_alive.size () <= 0) {
-		for (Species<Types...>& spe : species) {
-			logger->warn ("all the species are dead. To be able to make crossover, they are now alive like they never disappeared...");
-			spe.isDead = false;
-			spe.allowedOffspring = 0;
-			species_alive.push_back(spe.id);
+	}, 0, 1);
+
+	// the elites are moved rather than cloned, with their optimized network and their fitness, once they are no longer read as parents
+	// their run state is reset as a clone's would be, so that they run as if they were new
+	for (unsigned int k = 0; k < firstOffspring; k++) {
+		offsprings [k] = std::move (genomes [elites [k]]);
+		offsprings [k]->resetMemory ();
+	}
+	nbElitesKept = firstOffspring;
+
+	// replace the current genomes by the new ones, the current ones being retired to be overwritten at the next generation
+	for (unsigned int genomeId = 0; genomeId < (unsigned int) offsprings.size (); genomeId++) {
+		offsprings [genomeId]->id = genomeId;
+		std::swap (genomes [genomeId], offsprings [genomeId]);
+		if (offsprings [genomeId] != nullptr) {
+			cache.retiredGenomes.push_back (std::move (offsprings [genomeId]));
 		}
 	}
-	for (int k = 0; k < (int) popSize - N_offsprings - (int) elitism; k++) {
-		// some offsprings are missing, let's help the weakest species
-		std::sort(species_alive.begin(), species_alive.end(), [&](const unsigned int& a, const unsigned int& b) {return species [a].allowedOffspring < species [b].allowedOffspring;});
-		species [species_alive [0]].allowedOffspring += 1;
-	}
-	for (int k = 0; k < (int) elitism + N_offsprings - (int) popSize; k++) {
-		// there is too meny offsprings, let's weaken the strongest species
-		std::sort(species_alive.begin(), species_alive.end(), [&](const unsigned int& a, const unsigned int& b) {return species [a].allowedOffspring > species [b].allowedOffspring;});
-		species [species_alive [0]].allowedOffspring -= 1;
-	}
-
-	// process offsprings
-	for (const Species<Types...>& spe : species) {
-		if (!spe.isDead) {
-			for (int k = 0; k < spe.allowedOffspring; k++) {
-
-				// choose pseudo-randomly a first parent
-				unsigned int iParent1 = SelectParent (spe.id);
-
-				if (Random_Double (0.0, 1.0, true, false) < crossover_rate && spe.members.size () > 1) {
-					// New genome comes from a crossover
-
-					// choose pseudo-randomly a second parent
-					unsigned int iParent2 = SelectParent (spe.id);	// TODO might be the same parent as iParent1: is that an issue?
-
-					// clone the more fit
-					unsigned int iMainParent;
-					unsigned int iSecondParent;
-					if (genomes [iParent1]->fitness > genomes [iParent2]->fitness) {
-						iMainParent = iParent1;
-						iSecondParent = iParent2;
-					} else {
-						iMainParent = iParent2;
-						iSecondParent = iParent1;
-					}
-
-					newGenomes.insert (std::make_pair (genomeId, genomes [iMainParent]->clone ()));
-					std::unique_ptr<Genome<Types...>>& genome = newGenomes [genomeId];
-					genome->id = genomeId;
-					genomeId++;
-
-					// connections shared by both of the parents must be randomly wheighted
-					for (const std::pair<const unsigned int, Connection>& connMainParent : genomes [iMainParent]->connections) {
-						for (const std::pair<const unsigned int, Connection>& connSecondParent : genomes [iSecondParent]->connections) {
-							if (connMainParent.second.innovId == connSecondParent.second.innovId) {
-								if (Random_Double (0.0, 1.0, true, false) < 0.5) {	// 50 % of chance for each parent, newGenome already have the wheight of MainParent
-									genome->connections [connMainParent.second.id].weight = connSecondParent.second.weight;
-								}
-							}
-						}
-					}
-				} else {
-					// New genome comes from a mutation
-
-					newGenomes.insert (std::make_pair (genomeId, genomes [iParent1]->clone ()));
-					newGenomes [genomeId]->mutate (&conn_innov, &node_innov, mutationParams);
-					newGenomes [genomeId]->id = genomeId;
-					genomeId++;
-				}
-			}
+	for (unsigned int genomeId = (unsigned int) offsprings.size (); genomes.find (genomeId) != genomes.end (); genomeId++) {
+		if (genomes [genomeId] != nullptr) {
+			cache.retiredGenomes.push_back (std::move (genomes [genomeId]));
 		}
+		genomes.erase (genomeId);
 	}
-
-	// replace the current genomes by the new ones
-	genomes.clear ();
-	genomes = std::move (newGenomes);
+	RenumberInnovations (firstConnId, firstNodeId);
 
 	// reset species members
 	for (Species<Types...>& spe : species) {
@@ -1356,120 +1826,68 @@ void Population<Types...>::buildNextGen (const mutationParams_t& mutationParams,
 	generation ++;
 }
 
-
 template <typename... Types>
-void Population<Types...>::buildNextGen (const std::function<mutationParams_t (double)>& mutationParamsMap, bool elitism, double crossover_rate) {
-	logger->info ("Build the new generation");
-	std::unordered_map<unsigned int, std::unique_ptr<Genome<Types...>>> newGenomes;
-	newGenomes.reserve (popSize);
-
-	unsigned int genomeId = 0;
-
-	if (elitism) {	// elitism mode on = we conserve during generations the more fit genome
-		newGenomes.insert (std::make_pair (genomeId, genomes [fittergenome_id]->clone ()));
-		newGenomes [genomeId]->id = genomeId;
-		genomeId++;
+void Population<Types...>::RenumberInnovations (unsigned int firstConnId, unsigned int firstNodeId) {
+	// the innovations are numbered in the order they first appear in the genomes, rather than in the order the threads found them
+	std::vector<unsigned int> nodeOrder;
+	std::vector<unsigned int> connOrder;
+	for (unsigned int k = 0; k < (unsigned int) genomes.size (); k++) {
+		genomes.at (k)->NewInnovations (firstConnId, firstNodeId, connOrder, nodeOrder);
 	}
+	const std::vector<unsigned int> nodeRemap = node_innov.renumber (firstNodeId, nodeOrder);
+	const std::vector<unsigned int> connRemap = conn_innov.renumber (firstConnId, connOrder, firstNodeId, nodeRemap);
 
-	// scale the number of offsprings to the exact population's size
-	std::vector<unsigned int> species_alive;
-	int N_offsprings = 0; 
-	for (const Species<Types...>& spe : species) {
-		if (!spe.isDead) {
-			N_offsprings += spe.allowedOffspring;
-			species_alive.push_back(spe.id);
-		}
-	}
-	if (species_alive.size () <= 0) {
-		for (Species<Types...>& spe : species) {
-			logger->warn ("all the species are dead. To be able to make crossover, they are now alive like they never disappeared...");
-			spe.isDead = false;
-			spe.allowedOffspring = 0;
-			species_alive.push_back(spe.id);
-		}
-	}
-	for (int k = 0; k < (int) popSize - N_offsprings - (int) elitism; k++) {
-		// some offsprings are missing, let's help the weakest species
-		std::sort(species_alive.begin(), species_alive.end(), [&](const unsigned int& a, const unsigned int& b) {return species [a].allowedOffspring < species [b].allowedOffspring;});
-		species [species_alive [0]].allowedOffspring += 1;
-	}
-	for (int k = 0; k < (int) elitism + N_offsprings - (int) popSize; k++) {
-		// there is too meny offsprings, let's weaken the strongest species
-		std::sort(species_alive.begin(), species_alive.end(), [&](const unsigned int& a, const unsigned int& b) {return species [a].allowedOffspring > species [b].allowedOffspring;});
-		species [species_alive [0]].allowedOffspring -= 1;
+	for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
+		genome.second->RenumberInnovations (firstConnId, connRemap, firstNodeId, nodeRemap);
 	}
+}
 
-	// process offsprings
-	for (const Species<Types...>& spe : species) {
-		if (!spe.isDead) {
-			for (int k = 0; k < spe.allowedOffspring; k++) {
-
-				// choose pseudo-randomly a first parent
-				unsigned int iParent1 = SelectParent (spe.id);
-
-				if (Random_Double (0.0, 1.0, true, false) < crossover_rate && spe.members.size () > 1) {
-					// New genome comes from a crossover
-
-					// choose pseudo-randomly a second parent
-					unsigned int iParent2 = SelectParent (spe.id);	// TODO might be the same parent as iParent1: is that an issue?
-
-					// clone the more fit
-					unsigned int iMainParent;
-					unsigned int iSecondParent;
-					if (genomes [iParent1]->fitness > genomes [iParent2]->fitness) {
-						iMainParent = iParent1;
-						iSecondParent = iParent2;
-					} else {
-						iMainParent = iParent2;
-						iSecondParent = iParent1;
-					}
-
-					newGenomes.insert (std::make_pair (genomeId, genomes [iMainParent]->clone ()));
-					std::unique_ptr<Genome<Types...>>& genome = newGenomes [genomeId];
-					genome->id = genomeId;
-					genomeId++;
-
-					// connections shared by both of the parents must be randomly wheighted
-					for (const std::pair<const unsigned int, Connection>& connMainParent : genomes [iMainParent]->connections) {
-						for (const std::pair<const unsigned int, Connection>& connSecondParent : genomes [iSecondParent]->connections) {
-							if (connMainParent.second.innovId == connSecondParent.second.innovId) {
-								if (Random_Double (0.0, 1.0, true, false) < 0.5) {	// 50 % of chance for each parent, newGenome already have the wheight of MainParent
-									genome->connections [connMainParent.second.id].weight = connSecondParent.second.weight;
-								}
-							}
-						}
-					}
-				} else {
-					// New genome comes from a mutation
+template <typename... Types>
+void Population<Types...>::mutate (const mutationParams_t& params) {
+	logger->info ("Mutations");
+	const unsigned int firstConnId = conn_innov.N_connectionId;
+	const unsigned int firstNodeId = node_innov.N_nodeId;
+	pool.parallel_for (genomes.size (), [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		RandomScope random (Stream (MUTATION_STREAM, (unsigned int) i));
+		Genome<Types...>* genome = genomes.at ((unsigned int) i).get ();
+		genome->mutate (&conn_innov, &node_innov, params);
+	}, 0, 1);
+	RenumberInnovations (firstConnId, firstNodeId);
+}
 
-					newGenomes.insert (std::make_pair (genomeId, genomes [iParent1]->clone ()));
-					newGenomes [genomeId]->mutate (&conn_innov, &node_innov, mutationParamsMap (newGenomes [genomeId]->fitness));
-					newGenomes [genomeId]->id = genomeId;
-					genomeId++;
-				}
-			}
-		}
-	}
+template <typename... Types>
+void Population<Types...>::mutate (const std::function<mutationParams_t (double)>& paramsMap) {
+	logger->info ("Mutations");
+	const unsigned int firstConnId = conn_innov.N_connectionId;
+	const unsigned int firstNodeId = node_innov.N_nodeId;
+	pool.parallel_for (genomes.size (), [&] (size_t i, unsigned int worker) {
+		UNUSED (worker);
+		RandomScope random (Stream (MUTATION_STREAM, (unsigned int) i));
+		Genome<Types...>* genome = genomes.at ((unsigned int) i).get ();
+		genome->mutate (&conn_innov, &node_innov, paramsMap (genome->fitness));
+	}, 0, 1);
+	RenumberInnovations (firstConnId, firstNodeId);
+}
 
-	// replace the current genomes by the new ones
-	genomes.clear ();
-	genomes = std::move (newGenomes);
 
-	// reset species members
-	for (Species<Types...>& spe : species) {
-		spe.members.clear ();
-		spe.isDead = true;
-	}
-	for (const std::pair<const unsigned int, std::unique_ptr<Genome<Types...>>>& genome : genomes) {
-		if (genome.second->speciesId > -1) {
-			species [genome.second->speciesId].members.push_back (genome.first);
-			species [genome.second->speciesId].isDead = false;	// empty species will stay to isDead = true
-		}
-	}
+template <typename... Types>
+void Population<Types...>::buildNextGen (const mutationParams_t& mutationParams, bool elitism, double crossover_rate)  {
+	logger->info ("Build the new generation");
+	Reproduce (elitism, crossover_rate, [&] (Genome<Types...>& genome) {
+		// New genome comes from a mutation
+		genome.mutate (&conn_innov, &node_innov, mutationParams);
+	});
+}
 
-	fittergenome_id = -1;	// avoid a missuse of fittergenome_id
 
-	generation ++;
+template <typename... Types>
+void Population<Types...>::buildNextGen (const std::function<mutationParams_t (double)>& mutationParamsMap, bool elitism, double crossover_rate) {
+	logger->info ("Build the new generation");
+	Reproduce (elitism, crossover_rate, [&] (Genome<Types...>& genome) {
+		// New genome comes from a mutation
+		genome.mutate (&conn_innov, &node_innov, mutationParamsMap (genome.fitness));
+	});
 }
 
 
@@ -1578,6 +1996,8 @@ void Population<Types...>::serialize (std::ofstream& outFile) {
 
 	conn_innov.serialize (outFile);
 	node_innov.serialize (outFile);
+
+	Serialize (seed, outFile);
 }
 
 template <typename... Types>
@@ -1598,6 +2018,7 @@ void Population<Types...>::deserialize (std::ifstream& inFile) {
     Deserialize (maxRecuInit, inFile);
     Deserialize (dstType, inFile);
     Deserialize (fittergenome_id, inFile);
+    nbElitesKept = 0;   // the elites are not saved
 
 	size_t sz;
 
@@ -1617,6 +2038,16 @@ void Population<Types...>::deserialize (std::ifstream& inFile) {
 
 	conn_innov.deserialize (inFile);
 	node_innov.deserialize (inFile);
+
+	// the seed comes last, so that older files can still be read
+	uint64_t savedSeed = 0;
+	Deserialize (savedSeed, inFile);
+	if (inFile) {
+		seed = savedSeed;
+	} else {
+		logger->warn ("no random seed in the file: a new one is drawn");
+		seed = ((uint64_t) rand () << 32) ^ (uint64_t) rand ();
+	}
 }
 
 template <typename... Types>
@@ -0,0 +1,187 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+
+namespace pneatm {
+
+/**
+ * @brief A class representing a counter-based random generator (Philox4x32-10).
+ *
+ * Each block of four 32-bit values is a pure function of the seed and of a 128-bit counter, made of the block's index and of
+ * three words identifying the stream: two generators with different streams are independent, whatever the order they are drawn in.
+ * Being stateless but for the block's index, a stream can be created anywhere (e.g. one per genome and per generation) at no cost.
+ */
+class Philox {
+public:
+    /**
+     * @brief Constructor for the Philox class.
+     * @param seed The seed.
+     * @param stream0 The first word of the stream. (default is 0)
+     * @param stream1 The second word of the stream. (default is 0)
+     * @param stream2 The third word of the stream. (default is 0)
+     */
+    Philox (uint64_t seed = 0, uint32_t stream0 = 0, uint32_t stream1 = 0, uint32_t stream2 = 0);
+
+    /**
+     * @brief Get the next value of the stream.
+     * @return A value uniformly distributed in [0, 2^32 - 1].
+     */
+    uint32_t next ();
+
+    /**
+     * @brief Fill an array with the next values of the stream, block by block.
+     *
+     * It gives the same values as calling `next` n times, but the blocks are computed in a loop without dependencies between its iterations.
+     * @param values The array to fill.
+     * @param n The number of values.
+     */
+    void fill (uint32_t* values, size_t n);
+
+    /**
+     * @brief Serialize the Philox instance to an output file stream.
+     * @param outFile The output file stream to which the Philox instance will be written.
+     */
+    void serialize (std::ofstream& outFile) const;
+
+    /**
+     * @brief Deserialize a Philox instance from an input file stream.
+     * @param inFile The input file stream from which the Philox instance will be read.
+     */
+    void deserialize (std::ifstream& inFile);
+
+private:
+    uint32_t key [2];
+    uint32_t counter [4];   // the index of the next block, then the stream
+    uint32_t block [4];
+    unsigned int blockPos;  // the next value of block to give, 4 if it has been used
+
+    static void Block (const uint32_t* counter, const uint32_t* key, uint32_t* block);
+};
+
+/**
+ * @brief Get the generator used by `Random_Double` and `Random_UInt` on the calling thread.
+ * @return A reference to the pointer to the generator, nullptr if the C library's `rand()` is used.
+ */
+inline Philox*& CurrentGenerator () {
+    thread_local Philox* generator = nullptr;
+    return generator;
+}
+
+/**
+ * @brief A class making a generator the one of the calling thread, during its lifetime.
+ *
+ * Every random draw made in the scope, including the ones of the activation functions's parameters initializers and mutations, comes
+ * from the generator: the draws only depend on the stream, not on the thread nor on the draws made by other threads.
+ */
+class RandomScope {
+public:
+    /**
+     * @brief Constructor for the RandomScope class.
+     * @param generator The generator, which is copied.
+     */
+    explicit RandomScope (const Philox& generator) :
+        generator (generator),
+        previous (CurrentGenerator ())
+    {
+        CurrentGenerator () = &this->generator;
+    };
+
+    /**
+     * @brief Destructor for the RandomScope class: the previous generator of the thread is restored.
+     */
+    ~RandomScope () {
+        CurrentGenerator () = previous;
+    };
+
+    RandomScope (const RandomScope&) = delete;
+    RandomScope& operator= (const RandomScope&) = delete;
+
+private:
+    Philox generator;
+    Philox* previous;
+};
+
+inline Philox::Philox (uint64_t seed, uint32_t stream0, uint32_t stream1, uint32_t stream2) :
+    blockPos (4)
+{
+    key [0] = (uint32_t) seed;
+    key [1] = (uint32_t) (seed >> 32);
+    counter [0] = 0;
+    counter [1] = stream0;
+    counter [2] = stream1;
+    counter [3] = stream2;
+    block [0] = block [1] = block [2] = block [3] = 0;
+}
+
+inline void Philox::Block (const uint32_t* counter, const uint32_t* key, uint32_t* block) {
+    uint32_t c0 = counter [0], c1 = counter [1], c2 = counter [2], c3 = counter [3];
+    uint32_t k0 = key [0], k1 = key [1];
+    for (unsigned int round = 0; round < 10; round++) {
+        const uint64_t p0 = (uint64_t) 0xD2511F53u * c0;
+        const uint64_t p1 = (uint64_t) 0xCD9E8D57u * c2;
+        c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+        c1 = (uint32_t) p1;
+        c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+        c3 = (uint32_t) p0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    block [0] = c0;
+    block [1] = c1;
+    block [2] = c2;
+    block [3] = c3;
+}
+
+inline uint32_t Philox::next () {
+    if (blockPos >= 4) {
+        Block (counter, key, block);
+        counter [0] ++;
+        blockPos = 0;
+    }
+    return block [blockPos ++];
+}
+
+inline void Philox::fill (uint32_t* values, size_t n) {
+    size_t i = 0;
+    // the rest of the current block
+    while (i < n && blockPos < 4) {
+        values [i ++] = block [blockPos ++];
+    }
+    // whole blocks, written in place
+    const size_t nbBlocks = (n - i) / 4;
+    const uint32_t first = counter [0];
+    for (size_t b = 0; b < nbBlocks; b++) {
+        const uint32_t blockCounter [4] = {first + (uint32_t) b, counter [1], counter [2], counter [3]};
+        Block (blockCounter, key, values + i + 4 * b);
+    }
+    counter [0] = first + (uint32_t) nbBlocks;
+    i += 4 * nbBlocks;
+    // the beginning of a new block
+    while (i < n) {
+        values [i ++] = next ();
+    }
+}
+
+inline void Philox::serialize (std::ofstream& outFile) const {
+    outFile.write (reinterpret_cast<const char*> (key), sizeof (key));
+    outFile.write (reinterpret_cast<const char*> (counter), sizeof (counter));
+    outFile.write (reinterpret_cast<const char*> (&blockPos), sizeof (blockPos));
+}
+
+inline void Philox::deserialize (std::ifstream& inFile) {
+    inFile.read (reinterpret_cast<char*> (key), sizeof (key));
+    inFile.read (reinterpret_cast<char*> (counter), sizeof (counter));
+    inFile.read (reinterpret_cast<char*> (&blockPos), sizeof (blockPos));
+    if (blockPos < 4) {
+        // the current block has already been counted
+        const uint32_t blockCounter [4] = {counter [0] - 1, counter [1], counter [2], counter [3]};
+        Block (blockCounter, key, block);
+    }
+}
+
+}
+
+#endif  // RANDOM_HPP
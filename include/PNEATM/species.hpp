@@ -2,6 +2,7 @@
 #define SPECIES_HPP
 
 #include <PNEATM/Connection/connection.hpp>
+#include <PNEATM/Connection/gene_arrays.hpp>
 #include <PNEATM/genome.hpp>
 #include <PNEATM/utils.hpp>
 #include <vector>
@@ -20,6 +21,12 @@ enum distanceFn {
 	EUCLIDIAN
 };
 
+enum speciationPolicy {
+	EXACT_SPECIATION,
+	LSH_SPECIATION,
+	INDEXED_SPECIATION
+};
+
 /**
  * @brief A template class representing a species.
  * @tparam Types Variadic template arguments that contains all the manipulated types.
@@ -78,6 +85,7 @@ class Species {
 		unsigned int id;
 		distanceFn dstType;
 		std::unordered_map<unsigned int, Connection> connections;
+		geneArrays_t genes;	// the connections sorted by innovation ID
 		double avgFitness;
 		double avgFitnessAdjusted;
 		int allowedOffspring;
@@ -86,9 +94,13 @@ class Species {
 		bool isDead;
 		std::vector<unsigned int> members;
 
-		// distance functions
-		double ConventionalNEAT (const std::unique_ptr<Genome<Types...>>& genome, double a, double b, double c);
-		double Euclidian (const std::unique_ptr<Genome<Types...>>& genome);
+		// distance functions, between the genes of a genome and the ones of a species' leader
+		static double Distance (distanceFn dstType, const geneArrays_t& genesGenome, const geneArrays_t& genesLeader, double a, double b, double c);
+		static double ConventionalNEAT (const geneArrays_t& genesGenome, const geneArrays_t& genesLeader, double a, double b, double c);
+		static double ConventionalNEATBitsets (const geneArrays_t& genesGenome, const geneArrays_t& genesLeader, double a, double b, double c);
+		static unsigned int CountAbove (const std::vector<uint64_t>& bits, unsigned int innovId);
+		static double Euclidian (const geneArrays_t& genesGenome, const geneArrays_t& genesLeader);
+		static double EuclidianLowerBound (const geneArrays_t& genes1, const geneArrays_t& genes2);
 
 	template <typename... Types2>
 	friend class Population;
@@ -112,6 +124,7 @@ Species<Types...>::Species(unsigned int id, const std::unordered_map<unsigned in
 	sumFitness (0),
 	gensSinceImproved (0),
 	isDead (false) {
+	genes.build (connections);
 }
 
 template <typename... Types>
@@ -122,12 +135,18 @@ Species<Types...>::Species (std::ifstream& inFile) {
 
 template <typename... Types>
 double Species<Types...>::distanceWith (const std::unique_ptr<Genome<Types...>>& genome, double a, double b, double c) {
+	genome->UpdateGenes ();
+	return Distance (dstType, genome->genes, genes, a, b, c);
+}
+
+template <typename... Types>
+double Species<Types...>::Distance (distanceFn dstType, const geneArrays_t& genesGenome, const geneArrays_t& genesLeader, double a, double b, double c) {
 	switch (dstType) {
 		case CONVENTIONAL:
-			return ConventionalNEAT (genome, a, b, c);
+			return ConventionalNEAT (genesGenome, genesLeader, a, b, c);
 			break;
 		case EUCLIDIAN:
-			return Euclidian (genome);
+			return Euclidian (genesGenome, genesLeader);
 			break;
 	}
 	return 0.0;	// avoid compilator error
@@ -135,87 +154,76 @@ double Species<Types...>::distanceWith (const std::unique_ptr<Genome<Types...>>&
 
 
 template <typename... Types>
-double Species<Types...>::ConventionalNEAT (const std::unique_ptr<Genome<Types...>>& genome, double a, double b, double c) {
-	// get enabled connections and maxInnovId for genome 1
-	unsigned int maxInnovId1 = 0;
-	std::vector<unsigned int> connEnabled1;
-	for (const std::pair<const unsigned int, Connection>& conn : genome->connections) {
-		if (conn.second.enabled) {
-			connEnabled1.push_back (conn.second.id);
-			if (conn.second.innovId > maxInnovId1) {
-				maxInnovId1 = conn.second.innovId;
-			}
-		}
+double Species<Types...>::ConventionalNEAT (const geneArrays_t& genesGenome, const geneArrays_t& genesLeader, double a, double b, double c) {
+	if (genesGenome.enabledUnique && genesLeader.enabledUnique) {
+		// the bitsets describe the enabled genes exactly
+		return ConventionalNEATBitsets (genesGenome, genesLeader, a, b, c);
 	}
 
-	// get enabled connections and maxInnovId for genome 2
-	unsigned int maxInnovId2 = 0;
-	std::vector<unsigned int> connEnabled2;
-	for (const std::pair<const unsigned int, Connection>& conn : connections) {
-		if (conn.second.enabled) {
-			connEnabled2.push_back (conn.second.id);
-			if (conn.second.innovId > maxInnovId2) {
-				maxInnovId2 = conn.second.innovId;
-			}
-		}
-	}
+	// genome 1 is the genome, genome 2 is the species' leader: their enabled genes are aligned by a single merge pass
+	const geneArrays_t& genes1 = genesGenome;
+	const geneArrays_t& genes2 = genesLeader;
+	const size_t sz1 = genes1.size ();
+	const size_t sz2 = genes2.size ();
 
 	unsigned int excessGenes = 0;
 	unsigned int disjointGenes = 0;
-	double sumDiffWeights = 0.0;
 	unsigned int nbCommonGenes = 0;
 
-	for (unsigned int conn1 : connEnabled1) {
-		// for each enabled connection of the first genome
-		if (genome->connections [conn1].innovId > maxInnovId2) {
-			// if connection's innovId is over the maximum one of second genome's connections
-			// it is an excess gene
-			excessGenes += 1;
-		} else {
-			size_t i2 = 0;
-
-			while (i2 < connEnabled2.size () && connections [connEnabled2 [i2]].innovId != genome->connections [conn1].innovId) {
-				i2 ++;
-			}
-			if (i2 == connEnabled2.size ()) {
-				// no connection with the same innovation id have been found in the second genome
-				// it is a disjoint gene
+	// the weight's differences are summed by connection's ID of genome 1, as they always have been
+	thread_local std::vector<double> diffWeights;
+	diffWeights.assign (sz1, 0.0);
+
+	size_t i1 = 0;
+	size_t i2 = 0;
+	while (i1 < sz1 || i2 < sz2) {
+		// only enabled connections are compared
+		if (i1 < sz1 && !genes1.enabled [i1]) {
+			i1 ++;
+		} else if (i2 < sz2 && !genes2.enabled [i2]) {
+			i2 ++;
+		} else if (i2 >= sz2 || (i1 < sz1 && genes1.innovIds [i1] < genes2.innovIds [i2])) {
+			// no connection with the same innovation id in genome 2: it is an excess gene if it is over genome 2's maximum innovation id, a disjoint one otherwise
+			if (genes1.innovIds [i1] > genes2.maxEnabledInnovId) {
+				excessGenes += 1;
+			} else {
 				disjointGenes += 1;
+			}
+			i1 ++;
+		} else if (i1 >= sz1 || genes2.innovIds [i2] < genes1.innovIds [i1]) {
+			// same for a connection of genome 2
+			if (genes2.innovIds [i2] > genes1.maxEnabledInnovId) {
+				excessGenes += 1;
 			} else {
-				// one connection has the same innovation id
-				nbCommonGenes += 1;
-				double diff = connections [connEnabled2 [i2]].weight - genome->connections [conn1].weight;
-				if (diff > 0) {
-					sumDiffWeights += diff;
-				} else {
-					sumDiffWeights += -1 * diff;
-				}
+				disjointGenes += 1;
 			}
-		}
-	}
-
-	for (unsigned int conn2 : connEnabled2) {
-		// for each enabled connection of the second genome
-		if (connections [conn2].innovId > maxInnovId1) {
-			// if connection's innovId is over the maximum one of first genome's connections
-			// it is an excess gene
-			excessGenes += 1;
+			i2 ++;
 		} else {
-			size_t i1 = 0;
-			while (i1 < connEnabled1.size () && connections [conn2].innovId != genome->connections [connEnabled1 [i1]].innovId) {
+			// the same innovation id: each enabled connection of genome 1 is compared to the first enabled one of genome 2
+			const unsigned int innovId = genes1.innovIds [i1];
+			const double weight2 = genes2.weights [i2];
+			while (i1 < sz1 && genes1.innovIds [i1] == innovId) {
+				if (genes1.enabled [i1]) {
+					nbCommonGenes += 1;
+					double diff = weight2 - genes1.weights [i1];
+					diffWeights [genes1.connIds [i1]] = diff > 0 ? diff : -1 * diff;
+				}
 				i1 ++;
 			}
-			if (i1 == connEnabled1.size ()) {
-				// no connection with the same innovation id have been found in the first genome
-				// it is a disjoint gene
-				disjointGenes += 1;
-			}	// else, the weight's difference has already been processed in the previous for loop
+			while (i2 < sz2 && genes2.innovIds [i2] == innovId) {
+				i2 ++;
+			}
 		}
 	}
 
+	double sumDiffWeights = 0.0;
+	for (double diff : diffWeights) {
+		sumDiffWeights += diff;
+	}
+
 	if (nbCommonGenes > 0) {
 		return (
-			(a * (double) excessGenes + b * (double) disjointGenes) / (double) std::max (connEnabled1.size (), connEnabled2.size ())
+			(a * (double) excessGenes + b * (double) disjointGenes) / (double) std::max (genes1.nbEnabled, genes2.nbEnabled)
 			+ c * sumDiffWeights / (double) nbCommonGenes
 		);
 	} else {
@@ -226,39 +234,146 @@ double Species<Types...>::ConventionalNEAT (const std::unique_ptr<Genome<Types..
 }
 
 template <typename... Types>
-double Species<Types...>::Euclidian (const std::unique_ptr<Genome<Types...>>& genome) {
-	double result = 0.0;
+double Species<Types...>::ConventionalNEATBitsets (const geneArrays_t& genesGenome, const geneArrays_t& genesLeader, double a, double b, double c) {
+	// genome 1 is the genome, genome 2 is the species' leader: the genes are counted word by word over their bitsets of enabled innovation IDs
+	const geneArrays_t& genes1 = genesGenome;
+	const geneArrays_t& genes2 = genesLeader;
+	const std::vector<uint64_t>& bits1 = genes1.enabledBits;
+	const std::vector<uint64_t>& bits2 = genes2.enabledBits;
+	const size_t nbWordsCommon = std::min (bits1.size (), bits2.size ());
 
-	std::vector<size_t> usedId;
-	for (const std::pair<const unsigned int, Connection>& conn : connections) {
-		size_t i = 0;
-		while (i < genome->connections.size () && genome->connections [(unsigned int) i].innovId != conn.second.innovId) {
-			i++;
+	unsigned int nbCommonGenes = 0;
+	for (size_t w = 0; w < nbWordsCommon; w++) {
+		nbCommonGenes += Pop_Count (bits1 [w] & bits2 [w]);
+	}
+	if (nbCommonGenes <= 0) {
+		// there is no common genes between genomes
+		// let's return the maximum double as they might be very differents
+		return std::numeric_limits<double>::max ();
+	}
+
+	// the genes of one genome only are over the other one's maximum innovation id (excess genes) or not (disjoint genes)
+	const unsigned int excessGenes = CountAbove (bits1, genes2.maxEnabledInnovId) + CountAbove (bits2, genes1.maxEnabledInnovId);
+	const unsigned int disjointGenes = (unsigned int) (genes1.nbEnabled + genes2.nbEnabled) - 2 * nbCommonGenes - excessGenes;
+
+	// the weight's differences over the common genes only, summed by connection's ID of genome 1 as in the merge pass
+	thread_local std::vector<double> diffWeights;
+	diffWeights.assign (genes1.size (), 0.0);
+	for (size_t w = 0; w < nbWordsCommon; w++) {
+		uint64_t common = bits1 [w] & bits2 [w];
+		while (common) {
+			const unsigned int innovId = (unsigned int) (w * 64 + Trailing_Zeros (common));
+			const unsigned int i1 = genes1.enabledGene (innovId);
+			double diff = genes2.weights [genes2.enabledGene (innovId)] - genes1.weights [i1];
+			diffWeights [genes1.connIds [i1]] = diff > 0 ? diff : -1 * diff;
+			common &= common - 1;
 		}
-		if (i >= genome->connections.size ()) {
+	}
+
+	double sumDiffWeights = 0.0;
+	for (double diff : diffWeights) {
+		sumDiffWeights += diff;
+	}
+
+	return (
+		(a * (double) excessGenes + b * (double) disjointGenes) / (double) std::max (genes1.nbEnabled, genes2.nbEnabled)
+		+ c * sumDiffWeights / (double) nbCommonGenes
+	);
+}
+
+template <typename... Types>
+unsigned int Species<Types...>::CountAbove (const std::vector<uint64_t>& bits, unsigned int innovId) {
+	// the bits over innovId: the rest of its word, then the following words
+	const size_t first = (size_t) innovId / 64;
+	if (first >= bits.size ()) {
+		return 0;
+	}
+	unsigned int result = Pop_Count (bits [first] & ~(((uint64_t) 2 << (innovId % 64)) - 1));
+	for (size_t w = first + 1; w < bits.size (); w++) {
+		result += Pop_Count (bits [w]);
+	}
+	return result;
+}
+
+template <typename... Types>
+double Species<Types...>::Euclidian (const geneArrays_t& genesGenome, const geneArrays_t& genesLeader) {
+	// the leader's and the genome's connections are aligned by a single merge pass
+	const size_t szLeader = genesLeader.size ();
+	const size_t szGenome = genesGenome.size ();
+
+	// the squares are summed by connection's ID, the leader's first, as they always have been
+	thread_local std::vector<double> squares;
+	squares.assign (szLeader + szGenome, 0.0);
+
+	size_t iL = 0;
+	size_t iG = 0;
+	while (iL < szLeader || iG < szGenome) {
+		if (iG >= szGenome || (iL < szLeader && genesLeader.innovIds [iL] < genesGenome.innovIds [iG])) {
 			// the connection is not in the genome
-			result += conn.second.weight * conn.second.weight;
+			squares [genesLeader.connIds [iL]] = genesLeader.weights [iL] * genesLeader.weights [iL];
+			iL ++;
+		} else if (iL >= szLeader || genesGenome.innovIds [iG] < genesLeader.innovIds [iL]) {
+			// the connection is not in the leader
+			squares [szLeader + genesGenome.connIds [iG]] = genesGenome.weights [iG] * genesGenome.weights [iG];
+			iG ++;
 		} else {
-			usedId.push_back (i);
-			// the leader and the genome share this connection
-			result += (conn.second.weight - genome->connections [(unsigned int) i].weight) * (conn.second.weight - genome->connections [(unsigned int) i].weight);
+			// the leader and the genome share this connection: the leader's ones are compared to the first one of the genome
+			const unsigned int innovId = genesLeader.innovIds [iL];
+			const double weightGenome = genesGenome.weights [iG];
+			while (iL < szLeader && genesLeader.innovIds [iL] == innovId) {
+				squares [genesLeader.connIds [iL]] = (genesLeader.weights [iL] - weightGenome) * (genesLeader.weights [iL] - weightGenome);
+				iL ++;
+			}
+			iG ++;
+			while (iG < szGenome && genesGenome.innovIds [iG] == innovId) {
+				// the other ones of the genome have not been taken into account
+				squares [szLeader + genesGenome.connIds [iG]] = genesGenome.weights [iG] * genesGenome.weights [iG];
+				iG ++;
+			}
 		}
 	}
 
-	for (size_t i = 0; i < genome->connections.size (); i++) {
-		size_t k = 0;
-		while (k < usedId.size () && usedId [k] != i) {
-			k++;
-		}
-		if (k >= usedId.size ()) {
-			// the connection has not been take into account
-			result += genome->connections [(unsigned int) i].weight * genome->connections [(unsigned int) i].weight;
-		}
+	double result = 0.0;
+	for (double square : squares) {
+		result += square;
 	}
 
 	return result;	// actualy the euclidian distance is the squared root of result: but this has no effect as we are comparing values
 }
 
+template <typename... Types>
+double Species<Types...>::EuclidianLowerBound (const geneArrays_t& genes1, const geneArrays_t& genes2) {
+	// only the first connection of each innovation id is compared: the other ones only add squares to the euclidian distance, so this one is never higher,
+	// and its square root is a metric as the one between vectors of weights indexed by innovation id
+	const size_t sz1 = genes1.size ();
+	const size_t sz2 = genes2.size ();
+	double result = 0.0;
+	size_t i1 = 0;
+	size_t i2 = 0;
+	while (i1 < sz1 || i2 < sz2) {
+		double diff;
+		unsigned int innovId;
+		if (i2 >= sz2 || (i1 < sz1 && genes1.innovIds [i1] < genes2.innovIds [i2])) {
+			innovId = genes1.innovIds [i1];
+			diff = genes1.weights [i1];
+		} else if (i1 >= sz1 || genes2.innovIds [i2] < genes1.innovIds [i1]) {
+			innovId = genes2.innovIds [i2];
+			diff = genes2.weights [i2];
+		} else {
+			innovId = genes1.innovIds [i1];
+			diff = genes1.weights [i1] - genes2.weights [i2];
+		}
+		result += diff * diff;
+		while (i1 < sz1 && genes1.innovIds [i1] == innovId) {
+			i1 ++;
+		}
+		while (i2 < sz2 && genes2.innovIds [i2] == innovId) {
+			i2 ++;
+		}
+	}
+	return result;
+}
+
 template <typename... Types>
 void Species<Types...>::print (const std::string& prefix) const {
 	std::cout << prefix << "ID: " << id << std::endl;
@@ -305,8 +420,10 @@ void Species<Types...>::deserialize (std::ifstream& inFile) {
 	connections.clear ();
 	connections.reserve (sz);
 	for (unsigned int k = 0; k < (unsigned int) sz; k++) {
-		connections.insert (std::make_pair (k, Connection (inFile)));
+		Connection conn (inFile);
+		connections.insert (std::make_pair (conn.id, conn));
 	}
+	genes.build (connections);
 
 	Deserialize (avgFitness, inFile);
 	Deserialize (avgFitnessAdjusted, inFile);
@@ -3,24 +3,31 @@
 
 #include <thread>
 #include <vector>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
-#include <future>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
+#include <exception>
+#include <cstddef>
 
 namespace pneatm {
 
 /**
- * @brief A template class representing a thread pool.
- * @tparam T_Return Template typename of the functions's return type, assuming they all return the same type.
+ * @brief A class representing a persistent thread pool.
+ *
+ * The threads are started once and wait between two calls to `parallel_for`, which hands out contiguous ranges of indexes (chunks)
+ * through a single atomic counter: there is no task object, no future and no allocation per index.
+ * When the cost of each index is known, `parallel_for` deals them from the heaviest to the lightest into one deque per thread:
+ * each thread takes the heaviest index of its own deque and, once empty, steals the lightest index of the most loaded deque.
+ * The calling thread takes part in the work as the worker 0.
+ * If the function throws, no more index is handed out and the first exception is rethrown by `parallel_for` once every thread is done.
  */
-template <typename T_Return>
 class ThreadPool {
 public:
     /**
      * @brief Constructor for the ThreadPool class.
-     * @param numThreads The number of threads. (default is 0 which default to the number of cores)
+     * @param numThreads The number of threads, including the calling one. (default is 0 which default to the number of cores)
      */
     ThreadPool (unsigned int numThreads = 0);
 
@@ -29,94 +36,322 @@ public:
      */
     ~ThreadPool ();
 
+    ThreadPool (const ThreadPool&) = delete;
+    ThreadPool& operator= (const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the number of threads, including the calling one.
+     * @return The number of threads.
+     */
+    unsigned int getNumThreads () const {return (unsigned int) workers.size () + 1;};
+
+    /**
+     * @brief Call a function for every index of [0, n), in parallel.
+     * @tparam Func The function type.
+     * @param n The number of indexes.
+     * @param func The function, called as `func (size_t i, unsigned int worker)` with `worker` in [0, getNumThreads ()): two calls with the same worker are never concurrent.
+     * @param maxThreads Maximum number of threads. (default is 0 which default to every thread of the pool)
+     * @param chunkSize The number of contiguous indexes handed out at once. (default is 0 which gives about 4 chunks per thread)
+     *
+     * It returns once every index has been processed. A call made from a function run by a pool is run sequentially by the calling worker.
+     * If a call throws, the indexes not handed out yet are skipped and the first exception is rethrown, once every thread is done.
+     */
+    template <typename Func>
+    void parallel_for (size_t n, Func&& func, unsigned int maxThreads = 0, size_t chunkSize = 0);
+
     /**
-     * @brief Add a task to the queue.
+     * @brief Call a function for every index of [0, costs.size ()), in parallel, the heaviest indexes first.
      * @tparam Func The function type.
-     * @tparam Args Variadic template for the function's arguments types.
-     * @param func The function to be added to the queue.
-     * @param args The function's arguments.
-     * @return The std::future object of the function's return.
+     * @param costs The estimated cost of each index (only their order matters).
+     * @param func The function, called as `func (size_t i, unsigned int worker)` with `worker` in [0, getNumThreads ()): two calls with the same worker are never concurrent.
+     * @param maxThreads Maximum number of threads. (default is 0 which default to every thread of the pool)
+     *
+     * It returns once every index has been processed. A call made from a function run by a pool is run sequentially by the calling worker.
+     * If a call throws, the indexes not handed out yet are skipped and the first exception is rethrown, once every thread is done.
      */
-    template <typename Func, typename... Args>
-    std::future<T_Return> enqueue (Func&& func, Args&&... args);
+    template <typename Func>
+    void parallel_for (const std::vector<double>& costs, Func&& func, unsigned int maxThreads = 0);
 
 private:
+    struct workerQueue {
+        std::mutex mutex;
+        size_t front = 0;   // heaviest index left
+        size_t back = 0;    // following the lightest index left
+    };
+
+    static constexpr unsigned int NO_WORKER = ~0u;
+
+    // sets the worker of the calling thread and restores the previous one, even if the job throws
+    struct workerScope {
+        unsigned int& current;
+        const unsigned int previous;
+
+        workerScope (unsigned int worker) : current (CurrentWorker ()), previous (current) {current = worker;};
+        ~workerScope () {current = previous;};
+    };
+
     std::vector<std::thread> workers;
-    std::queue<std::packaged_task<T_Return ()>> tasks;
 
-    std::mutex queueMutex;
-    std::condition_variable condition;
+    std::mutex jobMutex;    // one job at a time
+    std::mutex stateMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    unsigned long long jobGeneration = 0;
+    unsigned int jobThreads = 0;    // number of threads taking part in the current job
+    unsigned int nbRunning = 0;     // pool's threads still working on the current job
     bool stop = false;
+
+    // the current job
+    void (*jobRange) (const void*, size_t, size_t, unsigned int) = nullptr;
+    const void* jobFunc = nullptr;
+    size_t jobSize = 0;
+    size_t jobChunk = 1;
+    std::atomic<size_t> jobNext {0};
+    bool jobStealing = false;
+    std::atomic<bool> jobFailed {false};    // no more index is handed out
+    std::exception_ptr jobError;    // the first exception thrown by the job [guarded by stateMutex]
+    std::vector<size_t> jobOrder;   // the deques of the workers, one after the other
+    std::vector<workerQueue> queues;
+
+    void Work (unsigned int worker);
+    void RunJob (unsigned int worker);
+    void RunChunks (unsigned int worker);
+    void RunQueues (unsigned int worker);
+    static unsigned int& CurrentWorker ();
+
+    template <typename Func>
+    bool RunHere (size_t n, Func& func, unsigned int& nbThreads, unsigned int maxThreads);
+    void Start (size_t n, unsigned int nbThreads);
+
+    template <typename Func>
+    static void Range (const void* func, size_t begin, size_t end, unsigned int worker);
 };
 
-template <typename T_Return>
-ThreadPool<T_Return>::ThreadPool (unsigned int numThreads) {
+inline ThreadPool::ThreadPool (unsigned int numThreads) {
     if (numThreads <= 0) {
         // defaulting to the number of core
-        numThreads = std::thread::hardware_concurrency ();
-    }
-
-    workers.reserve (numThreads);
-
-    for (unsigned int k = 0; k < numThreads; k++) {
-        // add a worker
-        workers.emplace_back ([&] () {
-            // the worker repeatedly checks for tasks in the queue and executes them
-            while (true) {
-                std::packaged_task<T_Return ()> task;
-                {
-                    std::unique_lock<std::mutex> lock (queueMutex);
-                    condition.wait (lock, [&] { return !tasks.empty () || stop; });
-                    if (stop && tasks.empty ()) {
-                        return;
-                    }
-                    task = std::move (tasks.front ());
-                    tasks.pop ();
-                }
-                task ();
-            }
-        });
+        numThreads = std::max (std::thread::hardware_concurrency (), 1u);
     }
+    queues = std::vector<workerQueue> (numThreads);
 
-    workers.shrink_to_fit ();
+    workers.reserve (numThreads - 1);
+    for (unsigned int k = 1; k < numThreads; k++) {
+        // add a worker, the calling thread being the worker 0
+        workers.emplace_back (&ThreadPool::Work, this, k);
+    }
 }
 
-template <typename T_Return>
-ThreadPool<T_Return>::~ThreadPool () {
+inline ThreadPool::~ThreadPool () {
     {
-        std::unique_lock<std::mutex> lock (queueMutex);
+        std::unique_lock<std::mutex> lock (stateMutex);
         stop = true;
-
-        condition.notify_all ();
     }
+    wakeCondition.notify_all ();
     for (std::thread& worker : workers) {
         worker.join ();
     }
 }
 
-template <typename T_Return>
-template <typename Func, typename... Args>
-std::future<T_Return> ThreadPool<T_Return>::enqueue (Func&& func, Args&&... args) {
-    // create the package task
-    std::packaged_task<T_Return ()> task (
-        std::bind (std::forward<Func> (func), std::forward<Args> (args)...)
-    );
+inline unsigned int& ThreadPool::CurrentWorker () {
+    thread_local unsigned int worker = NO_WORKER;
+    return worker;
+}
+
+inline void ThreadPool::Work (unsigned int worker) {
+    CurrentWorker () = worker;
+    unsigned long long seenGeneration = 0;
+    // the worker repeatedly waits for a job and takes chunks of it
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock (stateMutex);
+            wakeCondition.wait (lock, [&] { return stop || jobGeneration != seenGeneration; });
+            if (stop) {
+                return;
+            }
+            seenGeneration = jobGeneration;
+            if (worker >= jobThreads) {
+                continue;   // not part of this job
+            }
+        }
+        RunJob (worker);
+        {
+            std::unique_lock<std::mutex> lock (stateMutex);
+            nbRunning --;
+            if (nbRunning == 0) {
+                doneCondition.notify_one ();
+            }
+        }
+    }
+}
+
+inline void ThreadPool::RunJob (unsigned int worker) {
+    try {
+        if (jobStealing) {
+            RunQueues (worker);
+        } else {
+            RunChunks (worker);
+        }
+    } catch (...) {
+        // the other threads stop after their current index, the exception is given to the caller once they are done
+        std::unique_lock<std::mutex> lock (stateMutex);
+        if (!jobError) {
+            jobError = std::current_exception ();
+        }
+        jobFailed.store (true, std::memory_order_relaxed);
+    }
+}
 
-    // get the future result
-    std::future<T_Return> result = task.get_future ();
+inline void ThreadPool::RunChunks (unsigned int worker) {
+    while (!jobFailed.load (std::memory_order_relaxed)) {
+        const size_t begin = jobNext.fetch_add (jobChunk, std::memory_order_relaxed);
+        if (begin >= jobSize) {
+            return;
+        }
+        jobRange (jobFunc, begin, std::min (begin + jobChunk, jobSize), worker);
+    }
+}
+
+template <typename Func>
+void ThreadPool::Range (const void* func, size_t begin, size_t end, unsigned int worker) {
+    typedef typename std::remove_reference<Func>::type Fn;
+    Fn& f = *static_cast<Fn*> (const_cast<void*> (func));
+    for (size_t i = begin; i < end; i++) {
+        f (i, worker);
+    }
+}
+
+inline void ThreadPool::RunQueues (unsigned int worker) {
+    while (!jobFailed.load (std::memory_order_relaxed)) {
+        size_t i = jobSize;
+        {
+            // the heaviest index of its own deque
+            workerQueue& queue = queues [worker];
+            std::unique_lock<std::mutex> lock (queue.mutex);
+            if (queue.front < queue.back) {
+                i = jobOrder [queue.front ++];
+            }
+        }
+        while (i == jobSize) {
+            // or the lightest index of the most loaded deque
+            unsigned int victim = jobThreads;
+            size_t victimLoad = 0;
+            for (unsigned int w = 0; w < jobThreads; w++) {
+                std::unique_lock<std::mutex> lock (queues [w].mutex);
+                if (queues [w].back - queues [w].front > victimLoad) {
+                    victim = w;
+                    victimLoad = queues [w].back - queues [w].front;
+                }
+            }
+            if (victim == jobThreads) {
+                return;     // every deque is empty
+            }
+            std::unique_lock<std::mutex> lock (queues [victim].mutex);
+            if (queues [victim].front < queues [victim].back) {
+                i = jobOrder [-- queues [victim].back];
+            }
+        }
+        jobRange (jobFunc, i, i + 1, worker);
+    }
+}
+
+template <typename Func>
+bool ThreadPool::RunHere (size_t n, Func& func, unsigned int& nbThreads, unsigned int maxThreads) {
+    const unsigned int currentWorker = CurrentWorker ();
+    nbThreads = getNumThreads ();
+    if (maxThreads > 0 && maxThreads < nbThreads) {
+        nbThreads = maxThreads;
+    }
+    if ((size_t) nbThreads > n) {
+        nbThreads = (unsigned int) n;
+    }
+
+    if (currentWorker != NO_WORKER || nbThreads <= 1) {
+        // nested call or single thread: the indexes are processed here
+        const workerScope scope (currentWorker != NO_WORKER ? currentWorker : 0);
+        for (size_t i = 0; i < n; i++) {
+            func (i, scope.current);
+        }
+        return true;
+    }
+    return false;
+}
+
+inline void ThreadPool::Start (size_t n, unsigned int nbThreads) {
+    {
+        std::unique_lock<std::mutex> lock (stateMutex);
+        jobSize = n;
+        jobThreads = nbThreads;
+        nbRunning = nbThreads - 1;
+        jobFailed.store (false, std::memory_order_relaxed);
+        jobError = nullptr;
+        jobGeneration ++;
+    }
+    wakeCondition.notify_all ();
 
-    // add the task
     {
-        std::unique_lock<std::mutex> lock (queueMutex);
-        tasks.emplace (std::move (task));
+        // the calling thread works too
+        const workerScope scope (0);
+        RunJob (0);
+    }
+
+    std::unique_lock<std::mutex> lock (stateMutex);
+    doneCondition.wait (lock, [&] { return nbRunning == 0; });
+    if (jobError) {
+        std::exception_ptr error = jobError;
+        jobError = nullptr;
+        std::rethrow_exception (error);
+    }
+}
 
-        // there is a new task
-        condition.notify_one ();
+template <typename Func>
+void ThreadPool::parallel_for (size_t n, Func&& func, unsigned int maxThreads, size_t chunkSize) {
+    unsigned int nbThreads;
+    if (n == 0 || RunHere (n, func, nbThreads, maxThreads)) {
+        return;
     }
 
-    return result;
+    std::unique_lock<std::mutex> jobLock (jobMutex);
+    jobRange = &Range<Func>;
+    jobFunc = static_cast<const void*> (&func);
+    jobChunk = chunkSize > 0 ? chunkSize : std::max (n / (4 * (size_t) nbThreads), (size_t) 1);
+    jobNext.store (0, std::memory_order_relaxed);
+    jobStealing = false;
+    Start (n, nbThreads);
+}
+
+template <typename Func>
+void ThreadPool::parallel_for (const std::vector<double>& costs, Func&& func, unsigned int maxThreads) {
+    const size_t n = costs.size ();
+    unsigned int nbThreads;
+    if (n == 0 || RunHere (n, func, nbThreads, maxThreads)) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> jobLock (jobMutex);
+    jobRange = &Range<Func>;
+    jobFunc = static_cast<const void*> (&func);
+    jobStealing = true;
+
+    // deal the indexes from the heaviest to the lightest: the k-th heaviest goes to the deque k % nbThreads
+    std::vector<size_t> sorted (n);
+    for (size_t i = 0; i < n; i++) {
+        sorted [i] = i;
+    }
+    std::stable_sort (sorted.begin (), sorted.end (), [&] (size_t i1, size_t i2) {
+        return costs [i1] > costs [i2];
+    });
+    jobOrder.resize (n);
+    size_t begin = 0;
+    for (unsigned int w = 0; w < nbThreads; w++) {
+        queues [w].front = begin;
+        for (size_t k = w; k < n; k += nbThreads) {
+            jobOrder [begin ++] = sorted [k];
+        }
+        queues [w].back = begin;
+    }
+    Start (n, nbThreads);
 }
 
 }
 
-#endif  // THREAD_POOL_HPP
\ No newline at end of file
+#endif  // THREAD_POOL_HPP
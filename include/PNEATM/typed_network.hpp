@@ -0,0 +1,854 @@
+#ifndef TYPED_NETWORK_HPP
+#define TYPED_NETWORK_HPP
+
+#include <PNEATM/network_plan.hpp>
+#include <PNEATM/Node/node_base.hpp>
+#include <PNEATM/Node/node.hpp>
+#include <PNEATM/Node/Activation_Function/activation_function_base.hpp>
+#include <PNEATM/Node/Activation_Function/activation_function.hpp>
+#include <PNEATM/Node/Activation_Function/activation_kernels.hpp>
+#include <PNEATM/utils.hpp>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <cmath>
+#include <cctype>
+
+
+/* HEADER */
+
+namespace pneatm {
+
+/**
+ * @brief Type trait whose value is true if every type of the pack is an arithmetic type.
+ * @tparam Types The types to check.
+ */
+template <typename... Types>
+struct allArithmetic;
+
+template <>
+struct allArithmetic<> : std::true_type {};
+
+template <typename T, typename... Types>
+struct allArithmetic<T, Types...> : std::integral_constant<bool, std::is_arithmetic<T>::value && allArithmetic<Types...>::value> {};
+
+/**
+ * @brief Type trait whose value is the index of a type in a pack.
+ * @tparam T The type to look for.
+ * @tparam Types The pack.
+ */
+template <typename T, typename... Types>
+struct typeIndex;
+
+template <typename T, typename... Types>
+struct typeIndex<T, T, Types...> : std::integral_constant<size_t, 0> {};
+
+template <typename T, typename U, typename... Types>
+struct typeIndex<T, U, Types...> : std::integral_constant<size_t, 1 + typeIndex<T, Types...>::value> {};
+
+/**
+ * @brief Type trait giving the C++ spelling of an arithmetic type, nullptr for the other types.
+ * @tparam T The type.
+ */
+template <typename T>
+struct typeName {static const char* get () {return nullptr;}};
+
+template <> struct typeName<bool> {static const char* get () {return "bool";}};
+template <> struct typeName<char> {static const char* get () {return "char";}};
+template <> struct typeName<wchar_t> {static const char* get () {return "wchar_t";}};
+template <> struct typeName<char16_t> {static const char* get () {return "char16_t";}};
+template <> struct typeName<char32_t> {static const char* get () {return "char32_t";}};
+template <> struct typeName<signed char> {static const char* get () {return "signed char";}};
+template <> struct typeName<unsigned char> {static const char* get () {return "unsigned char";}};
+template <> struct typeName<short> {static const char* get () {return "short";}};
+template <> struct typeName<unsigned short> {static const char* get () {return "unsigned short";}};
+template <> struct typeName<int> {static const char* get () {return "int";}};
+template <> struct typeName<unsigned int> {static const char* get () {return "unsigned int";}};
+template <> struct typeName<long> {static const char* get () {return "long";}};
+template <> struct typeName<unsigned long> {static const char* get () {return "unsigned long";}};
+template <> struct typeName<long long> {static const char* get () {return "long long";}};
+template <> struct typeName<unsigned long long> {static const char* get () {return "unsigned long long";}};
+template <> struct typeName<float> {static const char* get () {return "float";}};
+template <> struct typeName<double> {static const char* get () {return "double";}};
+template <> struct typeName<long double> {static const char* get () {return "long double";}};
+
+/**
+ * @brief A template class holding the runtime values of a network in typed contiguous arrays.
+ *
+ * This is the generic version, used as soon as one of the manipulated types is not arithmetic: it holds nothing and is never built,
+ * so that the genome keeps running its network through its nodes.
+ * @tparam Enabled True if every manipulated type is arithmetic.
+ * @tparam Types Variadic template arguments that contains all the manipulated types.
+ */
+template <bool Enabled, typename... Types>
+class TypedNetwork {
+	public:
+		bool isBuilt () const {return false;};
+		void build (const networkPlan_t& plan, unsigned int nbBias, unsigned int nbInput, unsigned int nbOutput) {UNUSED (plan); UNUSED (nbBias); UNUSED (nbInput); UNUSED (nbOutput);};
+		void storeInputs () {};
+		void release () {};
+		void nodesUpdated () {};
+		void patchWeights (const networkPlan_t& plan) {UNUSED (plan);};
+		void patchActivations () {};
+		void loadInput (unsigned int input_id, void* value) {UNUSED (input_id); UNUSED (value);};
+		template <typename T_in>
+		bool loadInputs (const T_in* inputs, size_t n) {UNUSED (inputs); UNUSED (n); return false;}
+		template <typename T_out>
+		bool getOutputs (T_out* outputs, size_t n) {UNUSED (outputs); UNUSED (n); return false;}
+		bool run (unsigned int N_runNetwork) {UNUSED (N_runNetwork); return false;};
+		bool exportCpp (std::ostream& out, const std::string& name) const {UNUSED (out); UNUSED (name); return false;};
+};
+
+/**
+ * @brief A template class holding the runtime values of a network in typed contiguous arrays.
+ *
+ * When every manipulated type is arithmetic, the nodes's inputs and outputs are stored in one array per type, indexed by slot, and
+ * the plan's operations are split by type so that each accumulation is an inlined loop over plain values, without any virtual call or void pointer.
+ * Once built, the typed arrays own the inputs of the network: they are stored back in the nodes before being released. The outputs of
+ * the output nodes are written back in the nodes after each run, so that saving and getting outputs through the nodes still work.
+ * @tparam Types Variadic template arguments that contains all the manipulated types.
+ */
+template <typename... Types>
+class TypedNetwork<true, Types...> {
+	public:
+		/**
+		 * @brief Constructor for the TypedNetwork class.
+		 */
+		TypedNetwork ();
+
+		/**
+		 * @brief Check if the typed arrays are built.
+		 * @return True if the typed arrays are built.
+		 */
+		bool isBuilt () const {return built;};
+
+		/**
+		 * @brief Build the typed arrays from a network's plan and capture the nodes's state.
+		 * @param plan The network's plan.
+		 * @param nbBias The number of bias nodes.
+		 * @param nbInput The number of input nodes.
+		 * @param nbOutput The number of output nodes.
+		 */
+		void build (const networkPlan_t& plan, unsigned int nbBias, unsigned int nbInput, unsigned int nbOutput);
+
+		/**
+		 * @brief Store the inputs of the typed arrays in the input nodes.
+		 */
+		void storeInputs ();
+
+		/**
+		 * @brief Store the inputs in the input nodes and release the typed arrays, the nodes becoming the reference again.
+		 */
+		void release ();
+
+		/**
+		 * @brief Tell that the nodes's outputs have been updated outside of the typed arrays: they will be captured before the next run.
+		 */
+		void nodesUpdated () {synced = false;};
+
+		/**
+		 * @brief Copy the weights of the plan's operations, which must be the ones the typed arrays have been built from.
+		 * @param plan The network's plan.
+		 */
+		void patchWeights (const networkPlan_t& plan);
+
+		/**
+		 * @brief Capture the nodes's activation functions again, after some of them have been replaced.
+		 */
+		void patchActivations ();
+
+		/**
+		 * @brief Load an input.
+		 * @param input_id The ID of the input to load.
+		 * @param value A pointer to the input value.
+		 */
+		void loadInput (unsigned int input_id, void* value);
+
+		/**
+		 * @brief Load the inputs from a contiguous array.
+		 * @tparam T_in The type of the inputs.
+		 * @param inputs A pointer to the inputs.
+		 * @param n The number of inputs.
+		 * @return False if an input is not of type T_in, in which case nothing is loaded, true else.
+		 */
+		template <typename T_in>
+		bool loadInputs (const T_in* inputs, size_t n);
+
+		/**
+		 * @brief Write the outputs of the last run in a contiguous array.
+		 * @tparam T_out The type of the outputs.
+		 * @param outputs A pointer to the array to fill.
+		 * @param n The number of outputs.
+		 * @return False if an output is not of type T_out, true else.
+		 */
+		template <typename T_out>
+		bool getOutputs (T_out* outputs, size_t n);
+
+		/**
+		 * @brief Run the network.
+		 * @param N_runNetwork The number of runs already done.
+		 * @return 'false' if the network raised a NaN, 'true' else.
+		 */
+		bool run (unsigned int N_runNetwork);
+
+		/**
+		 * @brief Write a standalone C++ header running the network as run does. See Genome::exportCpp for the generated code.
+		 * @param out The stream to write the code to.
+		 * @param name The namespace of the generated code.
+		 * @return False if the network cannot be exported (a type has no C++ spelling or a node does not use a built-in kernel), true else.
+		 */
+		bool exportCpp (std::ostream& out, const std::string& name) const;
+
+	private:
+		template <typename T>
+		struct typedValues {
+			std::vector<T> inputs;	// by slot
+			std::vector<T> outputs;	// outputs [row * nbSlots + slot]
+			std::vector<T> resetValues;	// by slot
+			std::vector<unsigned int> resetSlots;
+			std::vector<unsigned int> opeSrc;
+			std::vector<unsigned int> opeDst;
+			std::vector<unsigned int> opeRecu;
+			std::vector<double> opeWeight;
+			std::vector<size_t> opePlan;	// index of the operation in the plan
+			std::vector<size_t> opeLayerBegin;
+			size_t recuBegin;
+			std::vector<size_t> recuActiveEnd;
+		};
+
+		typedef struct nodeFns {
+			bool (*process) (TypedNetwork*, size_t);
+			void (*capture) (TypedNetwork*, unsigned int);
+			const ActivationFnBase* (*activation) (TypedNetwork*, unsigned int);
+			void (*loadInput) (TypedNetwork*, unsigned int, void*);
+			void (*storeInput) (TypedNetwork*, unsigned int);
+			void (*writeOutput) (TypedNetwork*, unsigned int);
+			void (*pullOutputs) (TypedNetwork*, unsigned int);
+		} nodeFns_t;
+
+		static constexpr size_t N_types = sizeof... (Types);
+
+		std::tuple<typedValues<Types>...> values;
+		std::vector<NodeBase*> slots;
+		std::vector<size_t> pairs;	// by slot: index_T_in * N_types + index_T_out
+		std::vector<unsigned int> processSlots;
+		std::vector<size_t> processLayerBegin;
+		std::vector<const ActivationFnBase*> activations;	// aligned with processSlots
+		const nodeFns_t* fns;
+		size_t nbSlots;
+		size_t nbRows;
+		size_t head;
+		unsigned int nbBias;
+		unsigned int nbInput;
+		unsigned int nbOutput;
+		bool built;
+		bool synced;
+
+		size_t Row (size_t depth) const {return (head + nbRows - depth) % nbRows;};
+		void Sync ();
+
+		template <typename Func, size_t... I>
+		static void ForEachType (Func&& func, std::index_sequence<I...>);
+
+		template <size_t I, size_t J>
+		static bool Process (TypedNetwork* network, size_t k);
+		template <size_t I, size_t J>
+		static void Capture (TypedNetwork* network, unsigned int slot);
+		template <size_t I, size_t J>
+		static const ActivationFnBase* Activation (TypedNetwork* network, unsigned int slot);
+		template <size_t I, size_t J>
+		static void LoadInput (TypedNetwork* network, unsigned int slot, void* value);
+		template <size_t I, size_t J>
+		static void StoreInput (TypedNetwork* network, unsigned int slot);
+		template <size_t I, size_t J>
+		static void WriteOutput (TypedNetwork* network, unsigned int slot);
+		template <size_t I, size_t J>
+		static void PullOutputs (TypedNetwork* network, unsigned int slot);
+		template <size_t... K>
+		static const nodeFns_t* NodeFnsTable (std::index_sequence<K...>);
+
+		template <typename T>
+		static std::string Literal (T value);
+		template <typename T>
+		static std::string Literal (T value, std::true_type);
+		template <typename T>
+		static std::string Literal (T value, std::false_type);
+		static std::string KernelCall (const ActivationFnBase* activation, const std::string& x);
+};
+
+}
+
+
+/* IMPLEMENTATIONS */
+
+using namespace pneatm;
+
+template <typename... Types>
+TypedNetwork<true, Types...>::TypedNetwork () :
+	fns (nullptr),
+	nbSlots (0),
+	nbRows (1),
+	head (0),
+	nbBias (0),
+	nbInput (0),
+	nbOutput (0),
+	built (false),
+	synced (true)
+{}
+
+template <typename... Types>
+template <typename Func, size_t... I>
+void TypedNetwork<true, Types...>::ForEachType (Func&& func, std::index_sequence<I...>) {
+	int expand [] = {0, (func (std::integral_constant<size_t, I> ()), 0)...};
+	UNUSED (expand);
+}
+
+template <typename... Types>
+template <size_t I, size_t J>
+bool TypedNetwork<true, Types...>::Process (TypedNetwork* network, size_t k) {
+	typedef typename std::tuple_element<I, std::tuple<Types...>>::type T_in;
+	typedef typename std::tuple_element<J, std::tuple<Types...>>::type T_out;
+	const unsigned int slot = network->processSlots [k];
+	const T_out output = static_cast<const ActivationFn<T_in, T_out>*> (network->activations [k])->process (std::get<I> (network->values).inputs [slot]);
+	if (output != output) return false;
+	std::get<J> (network->values).outputs [network->head * network->nbSlots + slot] = output;
+	return true;
+}
+
+template <typename... Types>
+template <size_t I, size_t J>
+void TypedNetwork<true, Types...>::Capture (TypedNetwork* network, unsigned int slot) {
+	typedef typename std::tuple_element<I, std::tuple<Types...>>::type T_in;
+	typedef typename std::tuple_element<J, std::tuple<Types...>>::type T_out;
+	Node<T_in, T_out>* node = static_cast<Node<T_in, T_out>*> (network->slots [slot]);
+	std::get<I> (network->values).inputs [slot] = node->input;
+	std::get<I> (network->values).resetValues [slot] = node->resetValue;
+}
+
+template <typename... Types>
+template <size_t I, size_t J>
+const ActivationFnBase* TypedNetwork<true, Types...>::Activation (TypedNetwork* network, unsigned int slot) {
+	typedef typename std::tuple_element<I, std::tuple<Types...>>::type T_in;
+	typedef typename std::tuple_element<J, std::tuple<Types...>>::type T_out;
+	return static_cast<Node<T_in, T_out>*> (network->slots [slot])->activation_fn.get ();
+}
+
+template <typename... Types>
+template <size_t I, size_t J>
+void TypedNetwork<true, Types...>::LoadInput (TypedNetwork* network, unsigned int slot, void* value) {
+	typedef typename std::tuple_element<I, std::tuple<Types...>>::type T_in;
+	std::get<I> (network->values).inputs [slot] = *static_cast<T_in*> (value);
+}
+
+template <typename... Types>
+template <size_t I, size_t J>
+void TypedNetwork<true, Types...>::StoreInput (TypedNetwork* network, unsigned int slot) {
+	typedef typename std::tuple_element<I, std::tuple<Types...>>::type T_in;
+	typedef typename std::tuple_element<J, std::tuple<Types...>>::type T_out;
+	static_cast<Node<T_in, T_out>*> (network->slots [slot])->input = std::get<I> (network->values).inputs [slot];
+}
+
+template <typename... Types>
+template <size_t I, size_t J>
+void TypedNetwork<true, Types...>::WriteOutput (TypedNetwork* network, unsigned int slot) {
+	typedef typename std::tuple_element<I, std::tuple<Types...>>::type T_in;
+	typedef typename std::tuple_element<J, std::tuple<Types...>>::type T_out;
+	static_cast<Node<T_in, T_out>*> (network->slots [slot])->outputs_buf.insert (std::get<J> (network->values).outputs [network->head * network->nbSlots + slot]);
+}
+
+template <typename... Types>
+template <size_t I, size_t J>
+void TypedNetwork<true, Types...>::PullOutputs (TypedNetwork* network, unsigned int slot) {
+	typedef typename std::tuple_element<I, std::tuple<Types...>>::type T_in;
+	typedef typename std::tuple_element<J, std::tuple<Types...>>::type T_out;
+	Node<T_in, T_out>* node = static_cast<Node<T_in, T_out>*> (network->slots [slot]);
+	std::vector<T_out>& outputs = std::get<J> (network->values).outputs;
+	for (unsigned int depth = 0; depth <= node->max_depth_recu && depth < network->nbRows; depth++) {
+		outputs [network->Row (depth) * network->nbSlots + slot] = node->outputs_buf [depth];
+	}
+}
+
+template <typename... Types>
+template <size_t... K>
+const typename TypedNetwork<true, Types...>::nodeFns_t* TypedNetwork<true, Types...>::NodeFnsTable (std::index_sequence<K...>) {
+	// one entry per (T_in, T_out) pair
+	static const nodeFns_t table [] = {{
+		&Process<K / N_types, K % N_types>,
+		&Capture<K / N_types, K % N_types>,
+		&Activation<K / N_types, K % N_types>,
+		&LoadInput<K / N_types, K % N_types>,
+		&StoreInput<K / N_types, K % N_types>,
+		&WriteOutput<K / N_types, K % N_types>,
+		&PullOutputs<K / N_types, K % N_types>
+	}...};
+	return table;
+}
+
+template <typename... Types>
+void TypedNetwork<true, Types...>::build (const networkPlan_t& plan, unsigned int nbBias, unsigned int nbInput, unsigned int nbOutput) {
+	this->nbBias = nbBias;
+	this->nbInput = nbInput;
+	this->nbOutput = nbOutput;
+	fns = NodeFnsTable (std::make_index_sequence<N_types * N_types> ());
+
+	slots = plan.slots;
+	nbSlots = slots.size ();
+	pairs.resize (nbSlots);
+	for (size_t slot = 0; slot < nbSlots; slot++) {
+		pairs [slot] = slots [slot]->index_T_in * N_types + slots [slot]->index_T_out;
+	}
+	nbRows = (plan.recuBegin < plan.opeRecu.size () ? (size_t) plan.opeRecu.back () : 0) + 1;
+	head = 0;
+
+	ForEachType ([&] (auto type) {
+		typedef typename std::tuple_element<decltype (type)::value, std::tuple<Types...>>::type T;
+		typedValues<T>& typed = std::get<decltype (type)::value> (values);
+		typed.inputs.assign (nbSlots, T ());
+		typed.outputs.assign (nbRows * nbSlots, T ());
+		typed.resetValues.assign (nbSlots, T ());
+
+		typed.resetSlots.clear ();
+		for (unsigned int slot : plan.resetSlots) {
+			if (slots [slot]->index_T_in == decltype (type)::value) typed.resetSlots.push_back (slot);
+		}
+
+		// operations of this type, keeping the plan's order
+		typed.opeSrc.clear ();
+		typed.opeDst.clear ();
+		typed.opeRecu.clear ();
+		typed.opeWeight.clear ();
+		typed.opePlan.clear ();
+		typed.opeLayerBegin.assign (plan.nbLayers () + 1, 0);
+		const auto addOperations = [&] (size_t begin, size_t end) {
+			for (size_t k = begin; k < end; k++) {
+				if (slots [plan.opeDst [k]]->index_T_in == decltype (type)::value) {
+					typed.opeSrc.push_back (plan.opeSrc [k]);
+					typed.opeDst.push_back (plan.opeDst [k]);
+					typed.opeRecu.push_back (plan.opeRecu [k]);
+					typed.opeWeight.push_back (plan.opeWeight [k]);
+					typed.opePlan.push_back (k);
+				}
+			}
+		};
+		for (size_t ilayer = 0; ilayer < plan.nbLayers (); ilayer++) {
+			addOperations (plan.opeLayerBegin [ilayer], plan.opeLayerBegin [ilayer + 1]);
+			typed.opeLayerBegin [ilayer + 1] = typed.opeSrc.size ();
+		}
+		typed.recuBegin = typed.opeSrc.size ();
+		addOperations (plan.recuBegin, plan.opeSrc.size ());
+		typed.recuActiveEnd.assign (plan.recuActiveEnd.size (), typed.recuBegin);
+		size_t k = typed.recuBegin;
+		for (size_t n = 0; n < plan.recuActiveEnd.size (); n++) {
+			while (k < typed.opeRecu.size () && typed.opeRecu [k] <= n) {
+				k ++;
+			}
+			typed.recuActiveEnd [n] = k;
+		}
+	}, std::make_index_sequence<N_types> ());
+
+	// nodes's state and activation functions
+	for (unsigned int slot = 0; slot < (unsigned int) nbSlots; slot++) {
+		fns [pairs [slot]].capture (this, slot);
+	}
+	processSlots = plan.processSlots;
+	processLayerBegin = plan.processLayerBegin;
+	activations.resize (processSlots.size ());
+	for (size_t k = 0; k < processSlots.size (); k++) {
+		activations [k] = fns [pairs [processSlots [k]]].activation (this, processSlots [k]);
+	}
+
+	built = true;
+	synced = true;	// the nodes's buffers have just been setup
+}
+
+template <typename... Types>
+void TypedNetwork<true, Types...>::patchWeights (const networkPlan_t& plan) {
+	if (!built) return;
+	ForEachType ([&] (auto type) {
+		typedef typename std::tuple_element<decltype (type)::value, std::tuple<Types...>>::type T;
+		typedValues<T>& typed = std::get<decltype (type)::value> (values);
+		for (size_t k = 0; k < typed.opePlan.size (); k++) {
+			typed.opeWeight [k] = plan.opeWeight [typed.opePlan [k]];
+		}
+	}, std::make_index_sequence<N_types> ());
+}
+
+template <typename... Types>
+void TypedNetwork<true, Types...>::patchActivations () {
+	if (!built) return;
+	for (size_t k = 0; k < processSlots.size (); k++) {
+		activations [k] = fns [pairs [processSlots [k]]].activation (this, processSlots [k]);
+	}
+}
+
+template <typename... Types>
+void TypedNetwork<true, Types...>::storeInputs () {
+	if (!built) return;
+	for (unsigned int slot = nbBias; slot < nbBias + nbInput; slot++) {
+		fns [pairs [slot]].storeInput (this, slot);
+	}
+}
+
+template <typename... Types>
+void TypedNetwork<true, Types...>::release () {
+	storeInputs ();
+	built = false;
+}
+
+template <typename... Types>
+void TypedNetwork<true, Types...>::loadInput (unsigned int input_id, void* value) {
+	fns [pairs [nbBias + input_id]].loadInput (this, nbBias + input_id, value);
+}
+
+template <typename... Types>
+template <typename T_in>
+bool TypedNetwork<true, Types...>::loadInputs (const T_in* inputs, size_t n) {
+	constexpr size_t index = typeIndex<T_in, Types...>::value;
+	std::vector<T_in>& typed_inputs = std::get<index> (values).inputs;
+	for (size_t i = 0; i < n; i++) {
+		if (pairs [nbBias + i] / N_types != index) return false;
+	}
+	for (size_t i = 0; i < n; i++) {
+		typed_inputs [nbBias + i] = inputs [i];
+	}
+	return true;
+}
+
+template <typename... Types>
+template <typename T_out>
+bool TypedNetwork<true, Types...>::getOutputs (T_out* outputs, size_t n) {
+	Sync ();
+	constexpr size_t index = typeIndex<T_out, Types...>::value;
+	const T_out* typed_outputs = std::get<index> (values).outputs.data () + head * nbSlots;
+	for (size_t i = 0; i < n; i++) {
+		const size_t slot = nbBias + nbInput + i;
+		if (pairs [slot] % N_types != index) return false;
+		outputs [i] = typed_outputs [slot];
+	}
+	return true;
+}
+
+template <typename... Types>
+void TypedNetwork<true, Types...>::Sync () {
+	if (synced) return;
+	// capture the history written in the nodes
+	for (unsigned int slot : processSlots) {
+		fns [pairs [slot]].pullOutputs (this, slot);
+	}
+	synced = true;
+}
+
+template <typename... Types>
+bool TypedNetwork<true, Types...>::run (unsigned int N_runNetwork) {
+	Sync ();
+
+	// the oldest row is overwritten by this run
+	head = (head + 1) % nbRows;
+
+	// reset input and recurrent connections: the previous outputs are read relatively to the new row
+	ForEachType ([&] (auto type) {
+		typedef typename std::tuple_element<decltype (type)::value, std::tuple<Types...>>::type T;
+		typedValues<T>& typed = std::get<decltype (type)::value> (values);
+		T* inputs = typed.inputs.data ();
+		const T* outputs = typed.outputs.data ();
+
+		for (unsigned int slot : typed.resetSlots) {
+			inputs [slot] = typed.resetValues [slot];
+		}
+
+		const size_t recuEnd = N_runNetwork < typed.recuActiveEnd.size () ? typed.recuActiveEnd [N_runNetwork] : typed.recuActiveEnd.back ();
+		for (size_t k = typed.recuBegin; k < recuEnd; k++) {
+			inputs [typed.opeDst [k]] = static_cast<T> (inputs [typed.opeDst [k]] + outputs [Row (typed.opeRecu [k]) * nbSlots + typed.opeSrc [k]] * typed.opeWeight [k]);
+		}
+	}, std::make_index_sequence<N_types> ());
+
+	for (size_t ilayer = 0; ilayer + 1 < processLayerBegin.size (); ilayer++) {
+		// process of the layer's nodes
+		for (size_t k = processLayerBegin [ilayer]; k < processLayerBegin [ilayer + 1]; k++) {
+			if (!fns [pairs [processSlots [k]]].process (this, k)) return false;
+		}
+
+		// non-recurrent connections whose input node is in the layer
+		ForEachType ([&] (auto type) {
+			typedef typename std::tuple_element<decltype (type)::value, std::tuple<Types...>>::type T;
+			typedValues<T>& typed = std::get<decltype (type)::value> (values);
+			T* inputs = typed.inputs.data ();
+			const T* outputs = typed.outputs.data () + head * nbSlots;
+
+			for (size_t k = typed.opeLayerBegin [ilayer]; k < typed.opeLayerBegin [ilayer + 1]; k++) {
+				inputs [typed.opeDst [k]] = static_cast<T> (inputs [typed.opeDst [k]] + outputs [typed.opeSrc [k]] * typed.opeWeight [k]);
+			}
+		}, std::make_index_sequence<N_types> ());
+	}
+
+	// the output nodes keep track of their outputs
+	for (unsigned int slot = nbBias + nbInput; slot < nbBias + nbInput + nbOutput; slot++) {
+		fns [pairs [slot]].writeOutput (this, slot);
+	}
+
+	return true;
+}
+
+template <typename... Types>
+template <typename T>
+std::string TypedNetwork<true, Types...>::Literal (T value) {
+	return Literal (value, std::is_floating_point<T> ());
+}
+
+template <typename... Types>
+template <typename T>
+std::string TypedNetwork<true, Types...>::Literal (T value, std::true_type) {
+	const std::string type = typeName<T>::get ();
+	if (value != value) return "std::numeric_limits<" + type + ">::quiet_NaN ()";
+	if (std::isinf (value)) return std::string (value < T (0) ? "- " : "") + "std::numeric_limits<" + type + ">::infinity ()";
+	std::ostringstream literal;
+	literal << std::setprecision (std::numeric_limits<T>::max_digits10) << value;
+	std::string str = literal.str ();
+	if (str.find_first_of (".e") == std::string::npos) str += ".0";
+	if (std::is_same<T, float>::value) str += "f";
+	if (std::is_same<T, long double>::value) str += "L";
+	return str;
+}
+
+template <typename... Types>
+template <typename T>
+std::string TypedNetwork<true, Types...>::Literal (T value, std::false_type) {
+	std::ostringstream literal;
+	literal << "static_cast<" << typeName<T>::get () << "> (";
+	if (std::is_signed<T>::value) {
+		literal << static_cast<long long> (value);
+	} else {
+		literal << static_cast<unsigned long long> (value);
+	}
+	literal << ")";
+	return literal.str ();
+}
+
+template <typename... Types>
+std::string TypedNetwork<true, Types...>::KernelCall (const ActivationFnBase* activation, const std::string& x) {
+	static const char* const precisions [] = {"exact", "fast", "fastest"};
+	switch (activation->getKernel ()) {
+		case SIGMOID:
+			return "kernels::sigmoid_" + std::string (precisions [activation->getPrecision ()]) + " (" + x + ")";
+		case TANH:
+			return "kernels::tanh_" + std::string (precisions [activation->getPrecision ()]) + " (" + x + ")";
+		case RELU:
+			return "kernels::relu (" + x + ")";
+		case GAUSSIAN:
+			return "kernels::gaussian_" + std::string (precisions [activation->getPrecision ()]) + " (" + x + ")";
+		case SIN:
+			return "kernels::sin_" + std::string (precisions [activation->getPrecision ()]) + " (" + x + ")";
+		case ABS:
+			return "kernels::abs (" + x + ")";
+		case CLAMP:
+			return "kernels::clamp (" + x + ")";
+		default:	// IDENTITY
+			return x;
+	}
+}
+
+template <typename... Types>
+bool TypedNetwork<true, Types...>::exportCpp (std::ostream& out, const std::string& name) const {
+	if (!built) return false;
+	const std::vector<const char*> typeNames = {typeName<Types>::get ()...};
+	const std::vector<bool> floating = {std::is_floating_point<Types>::value...};	// only floating outputs can be NaN
+	for (const char* type : typeNames) {
+		if (type == nullptr) return false;
+	}
+	for (const ActivationFnBase* activation : activations) {
+		if (activation->getKernel () == CUSTOM) return false;
+	}
+
+	// literals of the bias nodes's inputs and of the reset values
+	std::vector<std::string> inputLiterals (nbSlots);
+	std::vector<std::string> resetLiterals (nbSlots);
+	ForEachType ([&] (auto type) {
+		const auto& typed = std::get<decltype (type)::value> (values);
+		for (size_t slot = 0; slot < nbSlots; slot++) {
+			if (pairs [slot] / N_types == decltype (type)::value) {
+				inputLiterals [slot] = Literal (typed.inputs [slot]);
+				resetLiterals [slot] = Literal (typed.resetValues [slot]);
+			}
+		}
+	}, std::make_index_sequence<N_types> ());
+
+	// inputs and outputs are given by type, in their order
+	std::vector<size_t> nbInputsOfType (N_types, 0);
+	std::vector<size_t> nbOutputsOfType (N_types, 0);
+	std::vector<size_t> indexInType (nbSlots, 0);
+	for (size_t slot = nbBias; slot < nbBias + nbInput; slot++) {
+		indexInType [slot] = nbInputsOfType [pairs [slot] / N_types] ++;
+	}
+	for (size_t slot = nbBias + nbInput; slot < nbBias + nbInput + nbOutput; slot++) {
+		indexInType [slot] = nbOutputsOfType [pairs [slot] % N_types] ++;
+	}
+
+	// recurrent connections read the outputs of the previous runs from histories
+	std::vector<bool> hasHistory (nbSlots, false);
+	ForEachType ([&] (auto type) {
+		const auto& typed = std::get<decltype (type)::value> (values);
+		for (size_t k = typed.recuBegin; k < typed.opeSrc.size (); k++) {
+			hasHistory [typed.opeSrc [k]] = true;
+		}
+	}, std::make_index_sequence<N_types> ());
+
+	std::string guard = name;
+	for (char& c : guard) {
+		c = std::isalnum (static_cast<unsigned char> (c)) ? static_cast<char> (std::toupper (static_cast<unsigned char> (c))) : '_';
+	}
+	const auto inType = [&] (size_t slot) {return std::string (typeNames [pairs [slot] / N_types]);};
+	const auto outType = [&] (size_t slot) {return std::string (typeNames [pairs [slot] % N_types]);};
+
+	out << "// Standalone inference code generated by PNEATM." << std::endl;
+	out << "// " << name << "::run computes one run of the network, exactly as Genome::runNetwork does:" << std::endl;
+	for (size_t slot = nbBias; slot < nbBias + nbInput; slot++) {
+		out << "//   inputs_" << pairs [slot] / N_types << " [" << indexInType [slot] << "] is the input " << slot - nbBias << " (" << inType (slot) << ")" << std::endl;
+	}
+	for (size_t slot = nbBias + nbInput; slot < nbBias + nbInput + nbOutput; slot++) {
+		out << "//   outputs_" << pairs [slot] % N_types << " [" << indexInType [slot] << "] is the output " << slot - nbBias - nbInput << " (" << outType (slot) << ")" << std::endl;
+	}
+	out << std::endl;
+	out << "#ifndef " << guard << "_HPP" << std::endl;
+	out << "#define " << guard << "_HPP" << std::endl;
+	out << std::endl;
+	out << "#include <cmath>" << std::endl;
+	out << "#include <limits>" << std::endl;
+	out << std::endl;
+	out << "namespace " << name << " {" << std::endl;
+	out << std::endl;
+	out << "namespace kernels {" << std::endl;
+	out << std::endl;
+	out << ActivationKernelsSource ();
+	out << std::endl;
+	out << "}" << std::endl;
+	out << std::endl;
+
+	// state: the recurrent history (Genome::resetMemory is a default constructed State)
+	out << "struct State {" << std::endl;
+	out << "\tunsigned int N_runNetwork = 0;\t// number of runs, saturated to the highest recurrency level" << std::endl;
+	out << "\tunsigned int head = 0;\t// row of the last run in the histories" << std::endl;
+	for (size_t slot = 0; slot < nbSlots; slot++) {
+		if (hasHistory [slot]) {
+			out << "\t" << outType (slot) << " history_" << slot << " [" << nbRows << "] = {};" << std::endl;
+		}
+	}
+	out << "};" << std::endl;
+	out << std::endl;
+
+	// signature
+	std::vector<std::string> parameters;
+	for (size_t i = 0; i < N_types; i++) {
+		if (nbInputsOfType [i] > 0) parameters.push_back ("const " + std::string (typeNames [i]) + "* inputs_" + std::to_string (i));
+	}
+	for (size_t i = 0; i < N_types; i++) {
+		if (nbOutputsOfType [i] > 0) parameters.push_back (std::string (typeNames [i]) + "* outputs_" + std::to_string (i));
+	}
+	out << "// returns false if the network raised a NaN" << std::endl;
+	out << "inline bool run (State& state";
+	for (const std::string& parameter : parameters) {
+		out << ", " << parameter;
+	}
+	out << ") {" << std::endl;
+	out << "\t(void) state;" << std::endl;
+	for (size_t i = 0; i < N_types; i++) {
+		if (nbInputsOfType [i] > 0) out << "\t(void) inputs_" << i << ";" << std::endl;
+	}
+	if (nbRows > 1) {
+		out << "\tstate.head = (state.head + 1) % " << nbRows << ";" << std::endl;
+	}
+	out << std::endl;
+
+	// inputs of the processed nodes
+	std::vector<bool> processed (nbSlots, false);
+	for (unsigned int slot : processSlots) {
+		processed [slot] = true;
+	}
+	out << "\t// inputs" << std::endl;
+	for (size_t slot = 0; slot < nbSlots; slot++) {
+		if (!processed [slot]) continue;
+		if (slot < nbBias) {
+			out << "\tconst " << inType (slot) << " in_" << slot << " = " << inputLiterals [slot] << ";" << std::endl;
+		} else if (slot < nbBias + nbInput) {
+			out << "\tconst " << inType (slot) << " in_" << slot << " = inputs_" << pairs [slot] / N_types << " [" << indexInType [slot] << "];" << std::endl;
+		} else {
+			out << "\t" << inType (slot) << " in_" << slot << " = " << resetLiterals [slot] << ";" << std::endl;
+		}
+	}
+	out << std::endl;
+
+	// recurrent connections, activated once their history exists
+	out << "\t// recurrent connections" << std::endl;
+	ForEachType ([&] (auto type) {
+		const auto& typed = std::get<decltype (type)::value> (values);
+		const std::string T = typeNames [decltype (type)::value];
+		size_t k = typed.recuBegin;
+		while (k < typed.opeSrc.size ()) {
+			const unsigned int recu = typed.opeRecu [k];
+			out << "\tif (state.N_runNetwork >= " << recu << ") {" << std::endl;
+			for (; k < typed.opeSrc.size () && typed.opeRecu [k] == recu; k++) {
+				out << "\t\tin_" << typed.opeDst [k] << " = static_cast<" << T << "> (in_" << typed.opeDst [k] << " + state.history_" << typed.opeSrc [k]
+					<< " [(state.head + " << nbRows - recu << ") % " << nbRows << "] * " << Literal (typed.opeWeight [k]) << ");" << std::endl;
+			}
+			out << "\t}" << std::endl;
+		}
+	}, std::make_index_sequence<N_types> ());
+
+	for (size_t ilayer = 0; ilayer + 1 < processLayerBegin.size (); ilayer++) {
+		out << std::endl;
+		out << "\t// layer " << ilayer << std::endl;
+		for (size_t k = processLayerBegin [ilayer]; k < processLayerBegin [ilayer + 1]; k++) {
+			const unsigned int slot = processSlots [k];
+			const bool floatKernel = inType (slot) == "float" && outType (slot) == "float";
+			const std::string K = floatKernel ? "float" : "double";
+			std::string x = "static_cast<" + K + "> (in_" + std::to_string (slot) + ")";
+			double alpha, beta;
+			if (activations [k]->getScaling (alpha, beta)) {
+				x = floatKernel ?
+					Literal (static_cast<float> (alpha)) + " * (" + x + " - " + Literal (static_cast<float> (beta)) + ")" :
+					Literal (alpha) + " * (" + x + " - " + Literal (beta) + ")";
+			}
+			out << "\tconst " << outType (slot) << " out_" << slot << " = static_cast<" << outType (slot) << "> (" << KernelCall (activations [k], x) << ");" << std::endl;
+			if (floating [pairs [slot] % N_types]) {
+				out << "\tif (out_" << slot << " != out_" << slot << ") return false;" << std::endl;
+			}
+		}
+		ForEachType ([&] (auto type) {
+			const auto& typed = std::get<decltype (type)::value> (values);
+			const std::string T = typeNames [decltype (type)::value];
+			for (size_t k = typed.opeLayerBegin [ilayer]; k < typed.opeLayerBegin [ilayer + 1]; k++) {
+				out << "\tin_" << typed.opeDst [k] << " = static_cast<" << T << "> (in_" << typed.opeDst [k] << " + out_" << typed.opeSrc [k] << " * " << Literal (typed.opeWeight [k]) << ");" << std::endl;
+			}
+		}, std::make_index_sequence<N_types> ());
+	}
+	out << std::endl;
+
+	// histories and outputs
+	out << "\t// outputs" << std::endl;
+	for (size_t slot = 0; slot < nbSlots; slot++) {
+		if (hasHistory [slot]) {
+			out << "\tstate.history_" << slot << " [state.head] = out_" << slot << ";" << std::endl;
+		}
+	}
+	for (size_t slot = nbBias + nbInput; slot < nbBias + nbInput + nbOutput; slot++) {
+		out << "\toutputs_" << pairs [slot] % N_types << " [" << indexInType [slot] << "] = out_" << slot << ";" << std::endl;
+	}
+	if (nbRows > 1) {
+		out << "\tif (state.N_runNetwork < " << nbRows - 1 << ") state.N_runNetwork ++;" << std::endl;
+	}
+	out << "\treturn true;" << std::endl;
+	out << "}" << std::endl;
+	out << std::endl;
+	out << "}" << std::endl;
+	out << std::endl;
+	out << "#endif" << std::endl;
+
+	return true;
+}
+
+#endif	// TYPED_NETWORK_HPP
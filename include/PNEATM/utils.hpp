@@ -6,6 +6,8 @@
 #include <fstream>
 #include <cstdlib>
 #include <unordered_map>
+#include <cstdint>
+#include <PNEATM/random.hpp>
 
 #define UNUSED(expr) do { (void) (expr); } while (0)
 #define UNUSED_PACK(...) do { (void) (sizeof...(__VA_ARGS__)); } while (0)
@@ -32,8 +34,9 @@ inline bool Eq_Double (double a, double b, double epsi = 1e-12) {
 /**
  * @brief Generate a random double value within the specified range.
  *
- * This function generates a random double value within the range [a, b]. The function uses the standard
- * C library's `rand()` function to generate a random floating-point value and scales it to a value within the range.
+ * This function generates a random double value within the range [a, b]. The function draws a random integer from the
+ * generator of the calling thread (see `RandomScope`), or from the standard C library's `rand()` function if there is none,
+ * and scales it to a value within the range.
  * By default, both endpoints `a` and `b` are included in the range, but this can be controlled using
  * the `a_included` and `b_included` parameters.
  *
@@ -44,28 +47,99 @@ inline bool Eq_Double (double a, double b, double epsi = 1e-12) {
  * @return A random double value within the specified range [a, b].
  */
 inline double Random_Double (double a, double b, bool a_included = true, bool b_included = true) {
+    Philox* generator = CurrentGenerator ();
+    const double value = generator != nullptr ? (double) generator->next () : (double) rand ();
+    const double max = generator != nullptr ? (double) UINT32_MAX : (double) RAND_MAX;
     return (
-            ((double) rand () + (double) !a_included)
+            (value + (double) !a_included)
         ) / (
-            (double) (RAND_MAX) + (double) !a_included + (double) !b_included
+            max + (double) !a_included + (double) !b_included
         ) * (b - a) + a;
 }
 
+/**
+ * @brief Generate random double values within the specified range.
+ *
+ * It gives the same values as calling `Random_Double` n times, but the generator of the calling thread draws them all at once.
+ *
+ * @param values The array to fill.
+ * @param n The number of values.
+ * @param a The lower bound of the range.
+ * @param b The upper bound of the range.
+ * @param a_included Set to true to include the lower bound `a` in the range. (default is true)
+ * @param b_included Set to true to include the upper bound `b` in the range. (default is true)
+ */
+inline void Random_Doubles (double* values, size_t n, double a, double b, bool a_included = true, bool b_included = true) {
+    Philox* generator = CurrentGenerator ();
+    if (generator == nullptr) {
+        for (size_t i = 0; i < n; i++) {
+            values [i] = Random_Double (a, b, a_included, b_included);
+        }
+        return;
+    }
+    const double max = (double) UINT32_MAX + (double) !a_included + (double) !b_included;
+    uint32_t draws [64];
+    for (size_t begin = 0; begin < n; begin += 64) {
+        const size_t count = n - begin < 64 ? n - begin : 64;
+        generator->fill (draws, count);
+        for (size_t i = 0; i < count; i++) {
+            values [begin + i] = ((double) draws [i] + (double) !a_included) / max * (b - a) + a;
+        }
+    }
+}
+
 /**
  * @brief Generate a random unsigned integer within the specified range.
  *
- * This function generates a random unsigned integer value within the range [a, b]. The function uses
- * the standard C library's `rand()` function to generate a random integer and applies the modulo
- * operation to ensure the generated value falls within the specified range.
+ * This function generates a random unsigned integer value within the range [a, b]. The function draws a random integer from
+ * the generator of the calling thread (see `RandomScope`), or from the standard C library's `rand()` function if there is none,
+ * and scales it to ensure the generated value falls within the specified range.
  *
  * @param a The lower bound of the range (inclusive).
  * @param b The upper bound of the range (inclusive).
  * @return A random unsigned integer within the specified range [a, b].
  */
 inline unsigned int Random_UInt (unsigned int a, unsigned int b) {
+    Philox* generator = CurrentGenerator ();
+    if (generator != nullptr) {
+        return (unsigned int) (((uint64_t) generator->next () * ((uint64_t) b - a + 1)) >> 32) + a;
+    }
     return (unsigned int) rand () % (b - a + 1) + a;
 }
 
+/**
+ * @brief Count the bits set in a 64-bit word.
+ *
+ * This function uses the compiler's builtin, a single instruction on most targets, and falls back to a portable
+ * bit-parallel count otherwise.
+ *
+ * @param x The word.
+ * @return The number of bits set in `x`.
+ */
+inline unsigned int Pop_Count (uint64_t x) {
+#if defined (__GNUC__) || defined (__clang__)
+    return (unsigned int) __builtin_popcountll (x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (unsigned int) ((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/**
+ * @brief Get the index of the lowest bit set in a 64-bit word.
+ * @param x The word, which must not be 0.
+ * @return The index of the lowest bit set in `x`.
+ */
+inline unsigned int Trailing_Zeros (uint64_t x) {
+#if defined (__GNUC__) || defined (__clang__)
+    return (unsigned int) __builtin_ctzll (x);
+#else
+    return Pop_Count ((x & (0 - x)) - 1);
+#endif
+}
+
 /**
  * @brief Serialize a single object of type T to an output file stream.
  * @tparam T The type of the object to be serialized.
@@ -0,0 +1,171 @@
+#ifndef VP_TREE_HPP
+#define VP_TREE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <cstddef>
+
+namespace pneatm {
+
+/**
+ * @brief A class representing a vantage-point tree over items identified by an unsigned integer, for nearest neighbour searches in a metric space.
+ *
+ * Each node holds a vantage point and splits the other items of its subtree by their distance to it: the ones closer than the median go inside,
+ * the others outside. The triangle inequality bounds the distance from a query to every item of a subtree, which is skipped if it cannot hold
+ * an item as close as the nearest one found so far. Items at exactly the same distance as the nearest one are never skipped, so that the caller
+ * can break the ties as it would with a full scan.
+ *
+ * The nearest item can be searched for another distance than the tree's metric, as long as it is never lower than it: the metric then only
+ * gives the bounds.
+ */
+class VPTree {
+public:
+    /**
+     * @brief Constructor for the VPTree class, giving an empty tree.
+     */
+    VPTree () {};
+
+    /**
+     * @brief Build the tree.
+     * @tparam Dist The type of the distance function.
+     * @param items The items, the first one being the vantage point of the root.
+     * @param distance The distance function between two items, `distance (item1, item2)`, which must be a metric.
+     */
+    template <typename Dist>
+    void build (const std::vector<unsigned int>& items, Dist distance);
+
+    /**
+     * @brief Get the number of items.
+     * @return The number of items.
+     */
+    size_t size () const {return nodes.size ();};
+
+    /**
+     * @brief Search the nearest item of a query, calling the distance function only on the items which could be the nearest one.
+     * @tparam Dist The type of the distance function.
+     * @param distanceTo The distance function from the query to an item, `distanceTo (item)`, giving a pair: their distance in the tree's metric,
+     * then the distance the nearest item is searched for, which must be at least the first one.
+     * @param bound The distance under which the nearest item is searched, the items further than it being skipped. (default is infinity)
+     * @return The nearest item and its distance, -1 and `bound` if there is no item closer than `bound`.
+     */
+    template <typename Dist>
+    std::pair<int, double> nearest (Dist distanceTo, double bound = std::numeric_limits<double>::infinity ()) const;
+
+private:
+    typedef struct node {
+        unsigned int item;
+        double innerMax;    // the highest distance from the vantage point to the items inside
+        double outerMin;    // the lowest distance from the vantage point to the items outside
+        int inside;
+        int outside;
+    } node_t;
+
+    std::vector<node_t> nodes;
+
+    template <typename Dist>
+    int Build (std::vector<std::pair<double, unsigned int>>& items, size_t begin, size_t end, Dist& distance);
+
+    static bool MayHold (double lowerBound, double best);
+};
+
+template <typename Dist>
+inline void VPTree::build (const std::vector<unsigned int>& items, Dist distance) {
+    nodes.clear ();
+    nodes.reserve (items.size ());
+    std::vector<std::pair<double, unsigned int>> work;  // (distance to the current vantage point, item)
+    work.reserve (items.size ());
+    for (unsigned int item : items) {
+        work.push_back (std::make_pair (0.0, item));
+    }
+    Build (work, 0, work.size (), distance);
+}
+
+template <typename Dist>
+inline int VPTree::Build (std::vector<std::pair<double, unsigned int>>& items, size_t begin, size_t end, Dist& distance) {
+    if (begin >= end) {
+        return -1;
+    }
+
+    const int nodeId = (int) nodes.size ();
+    const unsigned int vantage = items [begin].second;
+    nodes.push_back ({vantage, 0.0, 0.0, -1, -1});
+    begin ++;
+    if (begin >= end) {
+        return nodeId;
+    }
+
+    // the other items are split at the median of their distance to the vantage point, ties being broken by item so that the tree does not depend on the sort
+    for (size_t i = begin; i < end; i++) {
+        items [i].first = distance (vantage, items [i].second);
+    }
+    const size_t middle = begin + (end - begin) / 2;
+    std::nth_element (items.begin () + (std::ptrdiff_t) begin, items.begin () + (std::ptrdiff_t) middle, items.begin () + (std::ptrdiff_t) end);
+    double innerMax = 0.0;
+    for (size_t i = begin; i < middle; i++) {
+        innerMax = std::max (innerMax, items [i].first);
+    }
+    double outerMin = std::numeric_limits<double>::infinity ();
+    for (size_t i = middle; i < end; i++) {
+        outerMin = std::min (outerMin, items [i].first);
+    }
+
+    const int inside = Build (items, begin, middle, distance);
+    const int outside = Build (items, middle, end, distance);
+    nodes [nodeId].innerMax = innerMax;
+    nodes [nodeId].outerMin = outerMin;
+    nodes [nodeId].inside = inside;
+    nodes [nodeId].outside = outside;
+    return nodeId;
+}
+
+inline bool VPTree::MayHold (double lowerBound, double best) {
+    // the bound is loosened by a relative margin, which covers the rounding errors of the distances
+    return lowerBound <= best + 1e-9 * (best + lowerBound + 1.0);
+}
+
+template <typename Dist>
+inline std::pair<int, double> VPTree::nearest (Dist distanceTo, double bound) const {
+    int best = -1;
+    double dstBest = bound;
+    if (nodes.empty ()) {
+        return std::make_pair (best, dstBest);
+    }
+
+    std::vector<std::pair<int, double>> toVisit (1, std::make_pair (0, 0.0));    // (node, lower bound of the distance to its items)
+    while (!toVisit.empty ()) {
+        const std::pair<int, double> next = toVisit.back ();
+        toVisit.pop_back ();
+        if (!MayHold (next.second, dstBest)) {
+            // a closer item has been found since the node has been planned
+            continue;
+        }
+        const node_t& n = nodes [next.first];
+
+        const std::pair<double, double> dsts = distanceTo (n.item);
+        const double dst = dsts.first;
+        if (dsts.second < dstBest) {
+            best = (int) n.item;
+            dstBest = dsts.second;
+        }
+
+        // the triangle inequality gives a lower bound of the distance to the items of each side: the closest side is visited first
+        const double boundInside = std::max (dst - n.innerMax, next.second);
+        const double boundOutside = std::max (n.outerMin - dst, next.second);
+        const bool visitInside = n.inside >= 0 && MayHold (boundInside, dstBest);
+        const bool visitOutside = n.outside >= 0 && MayHold (boundOutside, dstBest);
+        if (boundInside < boundOutside) {
+            if (visitOutside) toVisit.push_back (std::make_pair (n.outside, boundOutside));
+            if (visitInside) toVisit.push_back (std::make_pair (n.inside, boundInside));
+        } else {
+            if (visitInside) toVisit.push_back (std::make_pair (n.inside, boundInside));
+            if (visitOutside) toVisit.push_back (std::make_pair (n.outside, boundOutside));
+        }
+    }
+    return std::make_pair (best, dstBest);
+}
+
+}
+
+#endif  // VP_TREE_HPP
@@ -0,0 +1,67 @@
+#include <genome_0.hpp>
+#include <genome_1.hpp>
+#include <genome_2.hpp>
+#include <genome_3.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/* Run the headers generated by generate.cpp on the recorded inputs and compare their outputs with the ones of runNetwork.
+ * This program does not depend on PNEATM: the generated headers must be standalone. */
+
+template <typename State>
+unsigned int Compare (std::istream& reference, bool (*run) (State&, const int*, const float*, int*, float*), const std::string& name) {
+    State state;
+    unsigned int nbErrors = 0;
+    unsigned int step = 0;
+    std::string line;
+    while (std::getline (reference, line) && line != "end") {
+        if (line == "reset") {
+            state = State ();
+            continue;
+        }
+        std::istringstream values (line);
+        int inputsInt [3];
+        float inputFloat;
+        bool expectedOk;
+        int expectedInt;
+        float expectedFloat;
+        values >> inputsInt [0] >> inputsInt [1] >> inputsInt [2] >> inputFloat >> expectedOk >> expectedInt >> expectedFloat;
+
+        int outputInt = 0;
+        float outputFloat = 0.0f;
+        const bool ok = run (state, inputsInt, &inputFloat, &outputInt, &outputFloat);
+        if (ok != expectedOk || (ok && (outputInt != expectedInt || outputFloat != expectedFloat))) {
+            std::cout << name << ", step " << step << ": got (" << ok << ", " << outputInt << ", " << outputFloat << ") instead of (" << expectedOk << ", " << expectedInt << ", " << expectedFloat << ")" << std::endl;
+            nbErrors ++;
+        }
+        step ++;
+    }
+    if (step == 0) {
+        std::cout << name << ": no step in the reference" << std::endl;
+        nbErrors ++;
+    }
+    return nbErrors;
+}
+
+int main (int argc, char* argv []) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv [0] << " <reference file>" << std::endl;
+        return 1;
+    }
+    std::ifstream reference (argv [1]);
+    if (!reference) {
+        std::cerr << "cannot open " << argv [1] << std::endl;
+        return 1;
+    }
+
+    unsigned int nbErrors = 0;
+    nbErrors += Compare<genome_0::State> (reference, &genome_0::run, "genome_0");
+    nbErrors += Compare<genome_1::State> (reference, &genome_1::run, "genome_1");
+    nbErrors += Compare<genome_2::State> (reference, &genome_2::run, "genome_2");
+    nbErrors += Compare<genome_3::State> (reference, &genome_3::run, "genome_3");
+
+    std::cout << nbErrors << " mismatch(es) between the exported code and runNetwork" << std::endl;
+    return nbErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+#include <PNEATM/population.hpp>
+#include <PNEATM/genome.hpp>
+#include <PNEATM/Node/Activation_Function/activation_function.hpp>
+#ifndef PURE_CPP
+    #include <spdlog/sinks/stdout_color_sinks.h>
+#endif
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+/* Evolve a small population, export some of its genomes with Genome::exportCpp and record the outputs of runNetwork on random inputs:
+ * the generated headers are then compiled, without PNEATM, by compare.cpp which checks that they give the very same outputs. */
+
+// parameters structure, alpha and beta scale the parameterised kernels
+typedef struct activationFnParams {
+    double alpha = pneatm::Random_Double (-2.0, 2.0);
+    double beta = pneatm::Random_Double (-2.0, 2.0);
+} activationFnParams_t;
+
+std::function<void (activationFnParams_t*, double)> mutationFn = [] (activationFnParams_t* params, double fitness) -> void {
+    params->alpha += pneatm::Random_Double (-0.2, 0.2);
+    params->beta += pneatm::Random_Double (-0.2, 0.2);
+    UNUSED (fitness);
+};
+
+const unsigned int nbGenomes = 4;   // must match compare.cpp and CMakeLists.txt
+const unsigned int nbSteps = 40;
+const unsigned int resetStep = 25;  // resetMemory is called before this step, to check that a default constructed State matches it
+
+int main (int argc, char* argv []) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv [0] << " <output directory>" << std::endl;
+        return 1;
+    }
+    const std::string directory = argv [1];
+
+    srand (7);  // seeds the whole evolution
+    auto logger = spdlog::stdout_color_mt ("console");
+
+    // one bias and one input of each type, plus two more int inputs, and one output of each type
+    std::vector<size_t> bias_sch = {1, 1};
+    std::vector<size_t> inputs_sch = {3, 1};
+    std::vector<size_t> outputs_sch = {1, 1};
+    std::vector<std::vector<size_t>> hiddens_sch_init = {{1, 1}, {1, 1}};
+    int biasInt = 1, resetInt = 0;
+    float biasFloat = 1.0f, resetFloat = 0.0f;
+    std::vector<void*> bias_values = {&biasInt, &biasFloat};
+    std::vector<void*> resetValues = {&resetInt, &resetFloat};
+
+    // only built-in kernels, so that every network can be exported
+    pneatm::ActivationFn<int, int> identityInt, reluInt;
+    pneatm::ActivationFn<float, float> identityFloat, tanhFloat;
+    pneatm::ActivationFn<int, float> sigmoidIntFloat;
+    pneatm::ActivationFn<float, int> clampFloatInt;
+    pneatm::ActivationFn<float, float> sigmoidOutput;
+    identityInt.setFunction (pneatm::IDENTITY);
+    reluInt.setFunction (pneatm::RELU, pneatm::EXACT, true);
+    identityFloat.setFunction (pneatm::IDENTITY);
+    tanhFloat.setFunction (pneatm::TANH, pneatm::FAST, true);
+    sigmoidIntFloat.setFunction (pneatm::SIGMOID, pneatm::FASTEST, true);
+    clampFloatInt.setFunction (pneatm::CLAMP, pneatm::EXACT, true);
+    sigmoidOutput.setFunction (pneatm::SIGMOID, pneatm::EXACT, true);
+
+    std::vector<std::vector<std::vector<pneatm::ActivationFnBase*>>> activationFns = {
+        {{&identityInt, &reluInt}, {&sigmoidIntFloat}},     // identity function MUST BE the first
+        {{&clampFloatInt}, {&identityFloat, &tanhFloat}}
+    };
+    for (std::vector<std::vector<pneatm::ActivationFnBase*>>& fns_in : activationFns) {
+        for (std::vector<pneatm::ActivationFnBase*>& fns : fns_in) {
+            for (pneatm::ActivationFnBase* fn : fns) {
+                fn->setMutationFunction (mutationFn);
+            }
+        }
+    }
+    std::vector<pneatm::ActivationFnBase*> inputsActivationFns = {&identityInt, &identityFloat, &identityInt, &identityInt, &identityInt, &identityFloat};
+    std::vector<pneatm::ActivationFnBase*> outputsActivationFns = {&identityInt, &sigmoidOutput};
+
+    const unsigned int popSize = 60;
+    const unsigned int maxRecu = 3;
+    pneatm::Population<int, float> pop (popSize, bias_sch, inputs_sch, outputs_sch, hiddens_sch_init, bias_values, resetValues, activationFns, inputsActivationFns, outputsActivationFns, 12, 0.3, 2.0, maxRecu, logger.get ());
+
+    pneatm::mutationParams_t params;
+    params.nodes.rate = 0.3;
+    params.nodes.monotypedRate = 0.5;
+    params.nodes.monotyped.maxIterationsFindConnection = 100;
+    params.nodes.bityped.maxRecurrencyEntryConnection = maxRecu;
+    params.nodes.bityped.maxIterationsFindNode = 100;
+    params.activation_functions.rate = 0.1;
+    params.connections.rate = 0.3;
+    params.connections.reactivateRate = 0.5;
+    params.connections.maxRecurrency = maxRecu;
+    params.connections.maxIterations = 100;
+    params.connections.maxIterationsFindNode = 100;
+    params.weights.rate = 0.3;
+    params.weights.fullChangeRate = 0.2;
+    params.weights.perturbationFactor = 0.2;
+
+    // the fitness only matters to grow networks with hidden and recurrent nodes
+    std::function<double (pneatm::Genome<int, float>&, pneatm::evalContext_t&)> evaluation = [] (pneatm::Genome<int, float>& genome, pneatm::evalContext_t& context) -> double {
+        double score = 0.0;
+        for (int t = 0; t < 10; t++) {
+            for (unsigned int i = 0; i < 3; i++) {
+                genome.loadInput<int> ((int) i + t, (int) i);
+            }
+            genome.loadInput<float> ((float) t * 0.1f, 3);
+            genome.runNetwork ();
+            score += (double) genome.getOutput<float> (1);
+        }
+        genome.resetMemory ();
+        UNUSED (context);
+        return score < 0.0 ? 0.0 : score;
+    };
+    for (unsigned int generation = 0; generation < 15; generation++) {
+        pop.evaluate (evaluation);
+        pop.speciate (4, 100, 0.3);
+        pop.buildNextGen (params, true, 0.5);
+    }
+
+    // the reference: for each genome, its steps ("reset" or the inputs followed by the outputs), then "end"
+    std::ofstream reference (directory + "/reference.txt");
+    reference << std::setprecision (std::numeric_limits<float>::max_digits10);
+    std::mt19937 inputsGenerator (42);
+    std::uniform_int_distribution<int> intInputs (-5, 5);
+    std::uniform_real_distribution<float> floatInputs (-5.0f, 5.0f);
+    for (unsigned int k = 0; k < nbGenomes; k++) {
+        pneatm::Genome<int, float>& genome = pop.getGenome ((int) k);
+        genome.resetMemory ();
+        if (!genome.exportCpp (directory + "/genome_" + std::to_string (k) + ".hpp", "genome_" + std::to_string (k))) {
+            std::cerr << "genome " << k << " could not be exported" << std::endl;
+            return 1;
+        }
+        for (unsigned int t = 0; t < nbSteps; t++) {
+            if (t == resetStep) {
+                genome.resetMemory ();
+                reference << "reset" << std::endl;
+            }
+            int inputsInt [3];
+            for (unsigned int i = 0; i < 3; i++) {
+                inputsInt [i] = intInputs (inputsGenerator);
+                genome.loadInput<int> (inputsInt [i], (int) i);
+            }
+            const float inputFloat = floatInputs (inputsGenerator);
+            genome.loadInput<float> (inputFloat, 3);
+            const bool ok = genome.runNetwork ();
+            reference << inputsInt [0] << " " << inputsInt [1] << " " << inputsInt [2] << " " << inputFloat << " " << ok << " " << genome.getOutput<int> (0) << " " << genome.getOutput<float> (1) << std::endl;
+            if (!ok) {
+                break;
+            }
+        }
+        reference << "end" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <PNEATM/thread_pool.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/* Check that an exception thrown by a function run by ThreadPool::parallel_for, on a pool's thread or on the calling one, reaches the caller
+ * and leaves the pool usable: the next jobs still run on every thread. */
+
+const unsigned int nbThreads = 4;
+
+std::atomic<unsigned int> nbErrors {0};    // checked by the pool's threads too
+
+void Check (bool condition, const std::string& message) {
+    if (!condition) {
+        std::cout << "error: " << message << std::endl;
+        nbErrors ++;
+    }
+}
+
+// wait until every thread of the job holds an index, so that each worker gets exactly one index (gives up after a few seconds)
+void Barrier (std::atomic<unsigned int>& arrived) {
+    arrived ++;
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now () + std::chrono::seconds (5);
+    while (arrived.load () < nbThreads && std::chrono::steady_clock::now () < deadline) {
+        std::this_thread::yield ();
+    }
+}
+
+// run a job of one index per thread, the worker thrower (NO_THROW for none) throwing; return the number of distinct workers
+const unsigned int NO_THROW = ~0u;
+unsigned int RunJob (pneatm::ThreadPool& pool, bool stealing, unsigned int thrower, const std::string& name) {
+    std::atomic<unsigned int> arrived {0};
+    std::vector<std::atomic<unsigned int>> calls (nbThreads);
+    for (std::atomic<unsigned int>& c : calls) {
+        c = 0;
+    }
+    std::function<void (size_t, unsigned int)> func = [&] (size_t i, unsigned int worker) {
+        calls [worker] ++;
+        Barrier (arrived);
+        if (worker == thrower) {
+            throw std::runtime_error (name + " " + std::to_string (i));
+        }
+    };
+
+    bool caught = false;
+    try {
+        if (stealing) {
+            pool.parallel_for (std::vector<double> (nbThreads, 1.0), func);
+        } else {
+            pool.parallel_for (nbThreads, func, 0, 1);
+        }
+    } catch (const std::runtime_error& e) {
+        caught = std::string (e.what ()).compare (0, name.size (), name) == 0;
+    }
+    Check (caught == (thrower != NO_THROW), name + ": the exception did not reach the caller");
+
+    unsigned int nbWorkers = 0;
+    for (std::atomic<unsigned int>& c : calls) {
+        nbWorkers += c.load () > 0 ? 1 : 0;
+    }
+    return nbWorkers;
+}
+
+int main () {
+    pneatm::ThreadPool pool (nbThreads);
+
+    const bool modes [2] = {false, true};
+    for (bool stealing : modes) {
+        const std::string mode = stealing ? "costs" : "chunks";
+        RunJob (pool, stealing, 2, mode + ", thrown by a pool's thread");
+        RunJob (pool, stealing, 0, mode + ", thrown by the calling thread");
+        Check (RunJob (pool, stealing, NO_THROW, mode + ", after the exceptions") == nbThreads, mode + ": the pool's threads are not used after the exceptions");
+    }
+
+    // once an exception is thrown, the indexes not handed out yet are skipped
+    std::atomic<unsigned int> nbCalls {0};
+    bool caught = false;
+    try {
+        pool.parallel_for (100000, [&] (size_t i, unsigned int worker) {
+            nbCalls ++;
+            if (i == 0) {
+                throw std::runtime_error ("first index");
+            }
+            (void) worker;
+        }, 0, 1);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    Check (caught && nbCalls.load () < 100000, "the job went on after the exception");
+
+    // an exception thrown by a job run sequentially, by the calling thread, must not make the next jobs sequential
+    caught = false;
+    try {
+        pool.parallel_for (10, [] (size_t i, unsigned int worker) {
+            (void) worker;
+            if (i == 5) {
+                throw std::runtime_error ("sequential");
+            }
+        }, 1);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    Check (caught, "sequential: the exception did not reach the caller");
+    Check (RunJob (pool, false, NO_THROW, "after the sequential exception") == nbThreads, "the next jobs are sequential after an exception thrown by a sequential one");
+
+    // an exception thrown by a nested call goes through the enclosing job
+    caught = false;
+    try {
+        pool.parallel_for (nbThreads, [&] (size_t i, unsigned int worker) {
+            pool.parallel_for (10, [&] (size_t j, unsigned int nestedWorker) {
+                Check (nestedWorker == worker, "nested: the nested call does not run on the calling worker");
+                if (i == 1 && j == 5) {
+                    throw std::runtime_error ("nested");
+                }
+            });
+        }, 0, 1);
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    Check (caught, "nested: the exception did not reach the caller");
+    Check (RunJob (pool, true, NO_THROW, "after the nested exception") == nbThreads, "the pool's threads are not used after a nested exception");
+
+    std::cout << nbErrors.load () << " error(s)" << std::endl;
+    return nbErrors.load () == 0 ? 0 : 1;
+}